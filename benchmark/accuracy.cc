@@ -0,0 +1,196 @@
+/*
+ * accuracy.cc
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Accuracy versus cost harness. A high accuracy reference of a generated 3d nanotip case is
+ *  computed first; then the solver settings are varied one at a time around the defaults and
+ *  the errors in the peak temperature, total emission current and maximum surface field are
+ *  reported against the wall time and the memory of the solver data structures (MemoryReport
+ *  totals of the Laplace and stationary solvers). Settings that are not beaten in both time and
+ *  error by another one are marked as Pareto optimal.
+ *
+ *  Usage: accuracy [report.csv] [target_cells] [applied_efield] [res_dir]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <deal.II/base/timer.h>
+
+#include "laplace.h"
+#include "physical_quantities.h"
+#include "currents_and_heating_stationary.h"
+#include "mesh_generator.h"
+
+namespace {
+
+/** One point of the sweep */
+struct Setting {
+    std::string parameter;          ///< name of the varied parameter
+    double value;                   ///< its value
+    unsigned long target_cells;     ///< size of the generated vacuum + copper meshes
+    double laplace_tol;             ///< CG tolerance of the Laplace solve
+    double ssor_param;              ///< SSOR relaxation parameter of the Laplace solve
+    double temperature_tol;         ///< Newton tolerance of the stationary solve [K]
+};
+
+struct Outcome {
+    unsigned long n_cells;
+    double wall_time;      ///< [s]
+    double memory;         ///< memory of the solver data structures [MB]
+    double peak_temperature;
+    double total_current;
+    double max_field;
+    double error;          ///< largest relative error of the three quantities
+    bool pareto;
+};
+
+Outcome run_setting(const Setting &setting, const double applied_efield, fch::PhysicalQuantities &pq) {
+    dealii::Timer timer;
+
+    fch::MeshGenerator<3> mesh_generator;
+    mesh_generator.set_grading(1.5, 1.5);
+    mesh_generator.set_target_cells(setting.target_cells);
+
+    fch::Laplace<3> laplace;
+    mesh_generator.generate_vacuum_mesh(laplace.get_triangulation());
+    laplace.set_applied_efield(applied_efield);
+    laplace.setup_system();
+    laplace.assemble_system();
+    laplace.solve(10000, setting.laplace_tol, true, setting.ssor_param);
+
+    fch::CurrentsAndHeatingStationary<3> ch(&pq, &laplace);
+    mesh_generator.generate_copper_mesh(ch.get_triangulation());
+    ch.setup_system();
+    ch.run_specific(setting.temperature_tol, 100, false, "", false);
+
+    Outcome outcome;
+    outcome.wall_time = timer.wall_time();
+    outcome.n_cells = mesh_generator.n_vacuum_cells() + mesh_generator.n_copper_cells();
+
+    // the process RSS would include the earlier settings, so sum the sizes reported by the solvers
+    outcome.memory = (laplace.get_memory_report().total() + ch.get_memory_report().total())
+            / (1024.0 * 1024.0);
+
+    outcome.peak_temperature = ch.get_max_temperature();
+    outcome.total_current = ch.get_total_current();
+    outcome.max_field = laplace.get_max_surface_field();
+    outcome.error = 0.0;
+    outcome.pareto = false;
+    return outcome;
+}
+
+double relative_error(const double value, const double reference) {
+    return std::abs(value - reference) / std::max(std::abs(reference), 1e-300);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::string report_file = argc > 1 ? argv[1] : "accuracy.csv";
+    const unsigned long target_cells = argc > 2 ? std::atol(argv[2]) : 20000;
+    const double applied_efield = argc > 3 ? std::atof(argv[3]) : 1.0;
+    const std::string res_path = argc > 4 ? argv[4] : "../res";
+
+    fch::PhysicalQuantities pq;
+    if (!(pq.load_emission_data(res_path + "/physical_quantities/gtf_200x200.dat")
+            && pq.load_nottingham_data(res_path + "/physical_quantities/nottingham_200x200.dat")
+            && pq.load_resistivity_data(res_path + "/physical_quantities/cu_res.dat"))) {
+        std::cout << "Couldn't load pq data, using default values..." << std::endl;
+    }
+
+    // Defaults of the solvers; the reference tightens all of them and refines the mesh
+    const Setting defaults = { "default", 0.0, target_cells, 1e-9, 1.2, 1.0 };
+    const Setting reference_setting = { "reference", 0.0, 8 * target_cells, 1e-12, 1.2, 1e-3 };
+
+    std::vector<Setting> settings;
+    settings.push_back(defaults);
+    for (double tol : { 1e-5, 1e-6, 1e-7, 1e-8, 1e-10 }) {
+        Setting s = defaults;
+        s.parameter = "laplace_tol";
+        s.value = s.laplace_tol = tol;
+        settings.push_back(s);
+    }
+    for (double omega : { 1.0, 1.4, 1.6, 1.8 }) {
+        Setting s = defaults;
+        s.parameter = "ssor_param";
+        s.value = s.ssor_param = omega;
+        settings.push_back(s);
+    }
+    for (double tol : { 10.0, 3.0, 0.3, 0.1 }) {
+        Setting s = defaults;
+        s.parameter = "temperature_tol";
+        s.value = s.temperature_tol = tol;
+        settings.push_back(s);
+    }
+    for (double factor : { 0.125, 0.25, 0.5, 2.0, 4.0 }) {
+        Setting s = defaults;
+        s.parameter = "mesh_cells";
+        s.target_cells = factor * target_cells;
+        s.value = s.target_cells;
+        settings.push_back(s);
+    }
+
+    std::cout << "Computing the reference solution..." << std::endl;
+    const Outcome reference = run_setting(reference_setting, applied_efield, pq);
+    std::printf("    cells=%lu time=%.2f s peak_T=%.4f K current=%.6e max_field=%.6f\n",
+            reference.n_cells, reference.wall_time, reference.peak_temperature,
+            reference.total_current, reference.max_field);
+
+    std::vector<Outcome> outcomes;
+    for (unsigned int i = 0; i < settings.size(); ++i) {
+        Outcome o = run_setting(settings[i], applied_efield, pq);
+        o.error = std::max(relative_error(o.peak_temperature, reference.peak_temperature),
+                std::max(relative_error(o.total_current, reference.total_current),
+                        relative_error(o.max_field, reference.max_field)));
+        outcomes.push_back(o);
+    }
+
+    // Pareto front in (wall time, error)
+    for (unsigned int i = 0; i < outcomes.size(); ++i) {
+        outcomes[i].pareto = true;
+        for (unsigned int j = 0; j < outcomes.size(); ++j)
+            if (j != i && outcomes[j].wall_time <= outcomes[i].wall_time
+                    && outcomes[j].error <= outcomes[i].error
+                    && (outcomes[j].wall_time < outcomes[i].wall_time
+                            || outcomes[j].error < outcomes[i].error)) {
+                outcomes[i].pareto = false;
+                break;
+            }
+    }
+
+    std::ofstream out(report_file);
+    out << "parameter,value,cells,laplace_tol,ssor_param,temperature_tol,wall_time_s,memory_mb,"
+            << "peak_temperature,err_peak_temperature,total_current,err_total_current,"
+            << "max_surface_field,err_max_surface_field,max_rel_error,pareto\n";
+    out.precision(8);
+
+    std::printf("%-16s %10s %9s %9s %9s %10s %10s %10s %10s  %s\n", "parameter", "value", "cells",
+            "time_s", "memory_mb", "err_T", "err_I", "err_F", "max_err", "pareto");
+    for (unsigned int i = 0; i < outcomes.size(); ++i) {
+        const Setting &s = settings[i];
+        const Outcome &o = outcomes[i];
+        const double err_t = relative_error(o.peak_temperature, reference.peak_temperature);
+        const double err_i = relative_error(o.total_current, reference.total_current);
+        const double err_f = relative_error(o.max_field, reference.max_field);
+
+        out << s.parameter << "," << s.value << "," << o.n_cells << "," << s.laplace_tol << ","
+                << s.ssor_param << "," << s.temperature_tol << "," << o.wall_time << "," << o.memory << ","
+                << o.peak_temperature << "," << err_t << "," << o.total_current << "," << err_i << ","
+                << o.max_field << "," << err_f << "," << o.error << "," << (o.pareto ? 1 : 0) << "\n";
+
+        std::printf("%-16s %10.3g %9lu %9.3f %9.1f %10.2e %10.2e %10.2e %10.2e  %s\n",
+                s.parameter.c_str(), s.value, o.n_cells, o.wall_time, o.memory, err_t, err_i, err_f,
+                o.error, o.pareto ? "*" : "");
+    }
+
+    std::cout << "Report written to " << report_file << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,196 @@
+/*
+ * alloc_test.cc
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Checks that the Newton iterations of the stationary solver and the time steps of the
+ *  transient solver do not allocate once their workspaces exist. The global operator new
+ *  is replaced by a counting version, and the allocations of every steady state iteration
+ *  are reported.
+ *
+ *  The Newton iterations reusing the factorized Jacobian must not allocate; the iterations
+ *  with a fresh factorization are only reported, as UMFPACK allocates its factors.
+ *  A time step may allocate only the residual histories of its returned statistics; the
+ *  time steps are checked both with the assembled and with the matrix-free heating system.
+ *
+ *  Usage: alloc_test [res_dir]
+ *  Exits with EXIT_FAILURE if a checked iteration allocates.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <sys/stat.h>  // for checking if directory exists
+
+#include "laplace.h"
+#include "physical_quantities.h"
+#include "currents_and_heating.h"
+#include "currents_and_heating_stationary.h"
+
+namespace {
+std::atomic<unsigned long> n_allocations(0);    ///< calls of operator new since the start
+}
+
+void* operator new(std::size_t size) {
+    ++n_allocations;
+    if (void *p = std::malloc(size > 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    ++n_allocations;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const double applied_efield = 10.0;     ///< [V/nm]
+const double time_step = 0.1e-15;       ///< [s]
+const unsigned int n_warmup_steps = 2;  ///< the first steps create the solver workspaces
+const unsigned int n_checked_steps = 5;
+
+/** Allocations of the time steps after the warm-up; returns the number of failed steps */
+unsigned int check_time_steps(const fch::Laplace<2> &laplace, const std::string &copper_mesh,
+        fch::PhysicalQuantities &pq, const bool matrix_free) {
+    fch::CurrentsAndHeating<2> ch(time_step, &pq);
+    ch.set_matrix_free_heating(matrix_free);
+    ch.import_mesh_from_file(copper_mesh);
+    ch.setup_current_system();
+    ch.setup_heating_system();
+    ch.set_electric_field_bc(laplace);
+
+    for (unsigned int step = 0; step < n_warmup_steps; ++step)
+        ch.do_time_step(step == 0);
+
+    unsigned int n_failed = 0;
+    for (unsigned int step = 0; step < n_checked_steps; ++step) {
+        const unsigned long before = n_allocations;
+        const fch::StepStats stats = ch.do_time_step();
+        const unsigned long allocations = n_allocations - before;
+
+        // the residual histories copied into the statistics
+        const unsigned long expected = (stats.current.residual_history.empty() ? 0 : 1)
+                + (stats.heat.residual_history.empty() ? 0 : 1);
+        const bool failed = allocations > expected;
+        n_failed += failed;
+        std::printf("    time step %u: %lu allocations, %lu for the statistics%s\n",
+                n_warmup_steps + step + 1, allocations, expected, failed ? "  FAILED" : "");
+    }
+    return n_failed;
+}
+
+/** Allocations of the Newton iterations that reuse the Jacobian; returns the number of failed iterations */
+unsigned int check_newton_iterations(fch::Laplace<2> &laplace, const std::string &copper_mesh,
+        fch::PhysicalQuantities &pq) {
+    fch::CurrentsAndHeatingStationary<2> ch(&pq, &laplace);
+    ch.import_mesh_from_file(copper_mesh);
+    ch.setup_system();
+    ch.set_jacobian_reuse(true);
+
+    // the iteration is measured from the end of the previous progress call to the end of its own
+    unsigned long last_count = 0;
+    unsigned int last_factorizations = 0;
+    unsigned int n_failed = 0, n_checked = 0;
+    ch.set_progress_callback([&](const fch::NewtonStats &stats) {
+        const unsigned long allocations = n_allocations - last_count;
+        const bool refactorized = stats.n_factorizations != last_factorizations;
+        if (stats.iterations > 1) {
+            const bool failed = !refactorized && allocations > 0;
+            n_failed += failed;
+            n_checked += !refactorized;
+            std::printf("    Newton iteration %d: %lu allocations%s%s\n", stats.iterations, allocations,
+                    refactorized ? " (fresh factorization, not checked)" : "", failed ? "  FAILED" : "");
+        }
+        last_factorizations = stats.n_factorizations;
+        last_count = n_allocations;
+    });
+
+    ch.run_specific(1e-2, 30, false, "", false);
+
+    if (n_checked == 0)
+        std::cout << "    WARNING: every Newton iteration took a fresh Jacobian, nothing was checked"
+                << std::endl;
+    return n_failed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+    std::string res_path = "";
+    struct stat info;
+    if (argc > 1) {
+        res_path = argv[1];
+    } else if (stat("../res", &info) == 0) {
+        res_path = "../res";
+    } else if (stat("heating/res", &info) == 0) {
+        res_path = "heating/res";
+    } else if (stat("res", &info) == 0) {
+        res_path = "res";
+    } else {
+        std::cout << "res/ folder not found. Pass it as the first argument. Exiting..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    fch::PhysicalQuantities pq;
+    if (!(pq.load_emission_data(res_path + "/physical_quantities/gtf_200x200.dat")
+            && pq.load_nottingham_data(res_path + "/physical_quantities/nottingham_200x200.dat")
+            && pq.load_resistivity_data(res_path + "/physical_quantities/cu_res.dat"))) {
+        std::cout << "Couldn't load pq data, using default values..." << std::endl;
+    }
+
+    const std::string mesh_2d = res_path + "/2d_meshes/";
+
+    fch::Laplace<2> laplace;
+    laplace.import_mesh_from_file(mesh_2d + "vacuum_aligned.msh");
+    laplace.set_applied_efield(applied_efield);
+    laplace.setup_system();
+    laplace.assemble_system();
+    laplace.solve();
+
+    std::cout << "Transient currents and heating:" << std::endl;
+    unsigned int failed_steps = check_time_steps(laplace, mesh_2d + "copper_aligned.msh", pq, false);
+
+    std::cout << "Transient currents and matrix-free heating:" << std::endl;
+    failed_steps += check_time_steps(laplace, mesh_2d + "copper_aligned.msh", pq, true);
+
+    std::cout << "Stationary currents and heating:" << std::endl;
+    const unsigned int failed_iterations = check_newton_iterations(laplace,
+            mesh_2d + "copper_aligned.msh", pq);
+
+    if (failed_steps > 0 || failed_iterations > 0) {
+        std::cout << "FAILED: " << failed_steps << " time steps and " << failed_iterations
+                << " Newton iterations allocated memory" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "No allocations in the steady state iterations" << std::endl;
+    return EXIT_SUCCESS;
+}
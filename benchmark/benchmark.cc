@@ -0,0 +1,279 @@
+/*
+ * benchmark.cc
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Standard performance suite: Laplace, transient and stationary currents & heating solves
+ *  on the bundled meshes. The timings of every phase are written to a JSON report.
+ *
+ *  Usage: benchmark [report.json] [res_dir] [case1,case2,...]
+ *  The optional case list selects the mesh pairs to run, e.g. 2d_aligned,3d_0
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>  // for checking if directory exists
+
+#include <deal.II/base/config.h>
+#include <deal.II/base/timer.h>
+
+#include "laplace.h"
+#include "physical_quantities.h"
+#include "currents_and_heating.h"
+#include "currents_and_heating_stationary.h"
+
+namespace {
+
+/** Timings and sizes of one benchmark case */
+struct CaseResult {
+    std::string name;
+    std::string solver;
+    int dim;
+    std::string mesh;
+    unsigned int n_dofs;
+    unsigned int iterations;
+    std::vector<std::pair<std::string, double> > phases;   ///< phase name and wall time in seconds
+
+    double total() const {
+        double t = 0.0;
+        for (unsigned int i = 0; i < phases.size(); ++i)
+            t += phases[i].second;
+        return t;
+    }
+};
+
+const std::string output_dir = "benchmark_output";
+const double time_step = 0.1e-15;        ///< time step of the transient runs [s]
+const unsigned int n_time_steps = 10;    ///< number of time steps of the transient runs
+
+std::string json_string(const std::string &s) {
+    std::string out = "\"";
+    for (unsigned int i = 0; i < s.size(); ++i) {
+        if (s[i] == '"' || s[i] == '\\')
+            out += '\\';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+void write_report(const std::string &file_name, const std::vector<CaseResult> &results) {
+    std::ostringstream os;
+    os.precision(6);
+    os << std::scientific;
+
+    os << "{\n";
+    os << "  \"suite\": \"fch_benchmark\",\n";
+    os << "  \"deal_ii_version\": " << json_string(DEAL_II_PACKAGE_VERSION) << ",\n";
+    os << "  \"cases\": [\n";
+    for (unsigned int i = 0; i < results.size(); ++i) {
+        const CaseResult &r = results[i];
+        os << "    {\n";
+        os << "      \"name\": " << json_string(r.name) << ",\n";
+        os << "      \"solver\": " << json_string(r.solver) << ",\n";
+        os << "      \"dim\": " << r.dim << ",\n";
+        os << "      \"mesh\": " << json_string(r.mesh) << ",\n";
+        os << "      \"n_dofs\": " << r.n_dofs << ",\n";
+        os << "      \"iterations\": " << r.iterations << ",\n";
+        os << "      \"phases\": {";
+        for (unsigned int j = 0; j < r.phases.size(); ++j)
+            os << (j == 0 ? "" : ", ") << json_string(r.phases[j].first) << ": " << r.phases[j].second;
+        os << "},\n";
+        os << "      \"total\": " << r.total() << "\n";
+        os << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n";
+    os << "}\n";
+
+    std::ofstream out(file_name);
+    if (!out) {
+        std::cerr << "WARNING: Couldn't open " + file_name << ". Report is written to stdout." << std::endl;
+        std::cout << os.str();
+        return;
+    }
+    out << os.str();
+}
+
+void print_result(const CaseResult &r) {
+    std::printf("    %-40s dofs=%8u iter=%5u", r.name.c_str(), r.n_dofs, r.iterations);
+    for (unsigned int i = 0; i < r.phases.size(); ++i)
+        std::printf(" %s=%7.3f", r.phases[i].first.c_str(), r.phases[i].second);
+    std::printf(" total=%7.3f\n", r.total());
+}
+
+/** Run Laplace, transient and stationary solves on a pair of vacuum and copper meshes */
+template<int dim>
+void run_case(const std::string &name, const std::string &vacuum_mesh, const std::string &copper_mesh,
+        const double applied_efield, fch::PhysicalQuantities &pq, std::vector<CaseResult> &results) {
+
+    dealii::Timer timer;
+
+    // Laplace
+    CaseResult laplace_result;
+    laplace_result.name = "laplace_" + name;
+    laplace_result.solver = "laplace";
+    laplace_result.dim = dim;
+    laplace_result.mesh = vacuum_mesh;
+
+    fch::Laplace<dim> laplace;
+    timer.restart();
+    laplace.import_mesh_from_file(vacuum_mesh);
+    laplace.set_applied_efield(applied_efield);
+    laplace_result.phases.push_back(std::make_pair("import", timer.wall_time()));
+    timer.restart();
+    laplace.setup_system();
+    laplace_result.phases.push_back(std::make_pair("setup", timer.wall_time()));
+    timer.restart();
+    laplace.assemble_system();
+    laplace_result.phases.push_back(std::make_pair("assemble", timer.wall_time()));
+    timer.restart();
+    laplace.solve();
+    laplace_result.phases.push_back(std::make_pair("solve", timer.wall_time()));
+    timer.restart();
+    laplace.output_results(output_dir + "/field_" + name + ".vtk");
+    laplace_result.phases.push_back(std::make_pair("output", timer.wall_time()));
+
+    laplace_result.n_dofs = laplace.get_dof_handler()->n_dofs();
+    laplace_result.iterations = laplace.get_n_iterations();
+    results.push_back(laplace_result);
+    print_result(results.back());
+
+    // Transient currents and heating
+    CaseResult transient_result;
+    transient_result.name = "transient_" + name;
+    transient_result.solver = "transient";
+    transient_result.dim = dim;
+    transient_result.mesh = copper_mesh;
+
+    fch::CurrentsAndHeating<dim> ch(time_step, &pq);
+    timer.restart();
+    ch.import_mesh_from_file(copper_mesh);
+    transient_result.phases.push_back(std::make_pair("import", timer.wall_time()));
+    timer.restart();
+    ch.setup_current_system();
+    ch.setup_heating_system();
+    ch.set_electric_field_bc(laplace);
+    transient_result.phases.push_back(std::make_pair("setup", timer.wall_time()));
+
+    double assemble_time = 0.0, solve_time = 0.0;
+    unsigned int iterations = 0;
+    for (unsigned int step = 0; step < n_time_steps; ++step) {
+        const fch::StepStats stats = ch.do_time_step(step == 0);
+        assemble_time += stats.assemble_current_time + stats.assemble_heat_time;
+        solve_time += stats.current.wall_time + stats.heat.wall_time;
+        iterations += stats.current.iterations + stats.heat.iterations;
+    }
+    transient_result.phases.push_back(std::make_pair("assemble", assemble_time));
+    transient_result.phases.push_back(std::make_pair("solve", solve_time));
+
+    timer.restart();
+    ch.output_results_current(output_dir + "/current_" + name + ".vtk");
+    ch.output_results_heating(output_dir + "/heat_" + name + ".vtk");
+    transient_result.phases.push_back(std::make_pair("output", timer.wall_time()));
+
+    // current and heat systems share the mesh and the element degree
+    transient_result.n_dofs = 2 * ch.get_dof_handler_current()->n_dofs();
+    transient_result.iterations = iterations;
+    results.push_back(transient_result);
+    print_result(results.back());
+
+    // Stationary currents and heating; the assembly and solve times are summed over the Newton iterations
+    CaseResult stationary_result;
+    stationary_result.name = "stationary_" + name;
+    stationary_result.solver = "stationary";
+    stationary_result.dim = dim;
+    stationary_result.mesh = copper_mesh;
+
+    fch::CurrentsAndHeatingStationary<dim> ch_stat(&pq, &laplace);
+    timer.restart();
+    ch_stat.import_mesh_from_file(copper_mesh);
+    stationary_result.phases.push_back(std::make_pair("import", timer.wall_time()));
+    timer.restart();
+    ch_stat.setup_system();
+    stationary_result.phases.push_back(std::make_pair("setup", timer.wall_time()));
+    const fch::NewtonStats newton_stats = ch_stat.run_specific(1.0, 100, false, "", false, 1.0);
+    stationary_result.phases.push_back(std::make_pair("mapping", newton_stats.mapping_time));
+    stationary_result.phases.push_back(std::make_pair("initial_condition", newton_stats.initial_condition_time));
+    stationary_result.phases.push_back(std::make_pair("assemble", newton_stats.assemble_time));
+    stationary_result.phases.push_back(std::make_pair("solve", newton_stats.solve_time));
+    timer.restart();
+    ch_stat.output_results(output_dir + "/stationary_" + name + ".vtk");
+    stationary_result.phases.push_back(std::make_pair("output", timer.wall_time()));
+
+    stationary_result.n_dofs = ch_stat.get_dof_handler()->n_dofs();
+    stationary_result.iterations = newton_stats.iterations;
+    results.push_back(stationary_result);
+    print_result(results.back());
+}
+
+/** True if the case is in the comma separated selection; empty selection selects all */
+bool is_selected(const std::string &name, const std::string &selection) {
+    if (selection.empty())
+        return true;
+    std::istringstream stream(selection);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (item == name)
+            return true;
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+
+    const std::string report_file = argc > 1 ? argv[1] : "benchmark.json";
+    const std::string selection = argc > 3 ? argv[3] : "";
+
+    std::string res_path = "";
+    struct stat info;
+    if (argc > 2) {
+        res_path = argv[2];
+    } else if (stat("../res", &info) == 0) {
+        res_path = "../res";
+    } else if (stat("heating/res", &info) == 0) {
+        res_path = "heating/res";
+    } else if (stat("res", &info) == 0) {
+        res_path = "res";
+    } else {
+        std::cout << "res/ folder not found. Pass it as the second argument. Exiting..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (stat(output_dir.c_str(), &info) != 0)
+        mkdir(output_dir.c_str(), 0755);
+
+    fch::PhysicalQuantities pq;
+    if (!(pq.load_emission_data(res_path + "/physical_quantities/gtf_200x200.dat")
+            && pq.load_nottingham_data(res_path + "/physical_quantities/nottingham_200x200.dat")
+            && pq.load_resistivity_data(res_path + "/physical_quantities/cu_res.dat"))) {
+        std::cout << "Couldn't load pq data, using default values..." << std::endl;
+    }
+
+    std::vector<CaseResult> results;
+
+    const std::string mesh_2d = res_path + "/2d_meshes/";
+    if (is_selected("2d_aligned", selection))
+        run_case<2>("2d_aligned", mesh_2d + "vacuum_aligned.msh", mesh_2d + "copper_aligned.msh",
+                10.0, pq, results);
+    if (is_selected("2d_aligned_dense", selection))
+        run_case<2>("2d_aligned_dense", mesh_2d + "vacuum_aligned_dense.msh",
+                mesh_2d + "copper_aligned_dense.msh", 10.0, pq, results);
+
+    const std::string mesh_3d = res_path + "/3d_meshes/";
+    for (int n = 0; n <= 3; ++n) {
+        const std::string name = "3d_" + std::to_string(n);
+        if (is_selected(name, selection))
+            run_case<3>(name, mesh_3d + "vacuum_" + std::to_string(n) + ".msh",
+                    mesh_3d + "copper_" + std::to_string(n) + ".msh", 1.5, pq, results);
+    }
+
+    write_report(report_file, results);
+    std::cout << "Benchmark report written to " << report_file << std::endl;
+
+    return EXIT_SUCCESS;
+}
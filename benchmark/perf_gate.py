@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+#
+# perf_gate.py
+#
+#  Created on: Oct 17, 2026
+#
+# Performance regression gate for the benchmark suite.
+#
+# Runs the benchmark executable several times and compares the median wall time of every
+# phase against a stored baseline. A phase regresses when its median exceeds the baseline
+# median by more than the noise of the measurements (scaled median absolute deviation)
+# and by more than a relative and an absolute floor. Exits with 1 if any phase regressed.
+#
+# Record a baseline:
+#   ./perf_gate.py --update-baseline baseline.json --runs 5 --cases 2d_aligned,3d_0
+# Check against it:
+#   ./perf_gate.py baseline.json --runs 5
+#
+# A single benchmark report (benchmark.json) can be used as a baseline too;
+# then only the floors apply, as there is no spread to estimate the noise from.
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+MAD_TO_SIGMA = 1.4826   # MAD of normally distributed samples times this estimates the standard deviation
+
+
+def median_mad(samples):
+    median = statistics.median(samples)
+    mad = statistics.median([abs(s - median) for s in samples])
+    return median, MAD_TO_SIGMA * mad
+
+
+def run_benchmark(executable, res_dir, cases, runs):
+    """Run the benchmark runs times; returns {case: {phase: [seconds, ...]}} and {case: n_dofs}"""
+    samples = {}
+    n_dofs = {}
+    for run in range(runs):
+        with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as f:
+            report_file = f.name
+        try:
+            command = [executable, report_file, res_dir]
+            if cases:
+                command.append(cases)
+            print("    run %d/%d: %s" % (run + 1, runs, " ".join(command)))
+            subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+            with open(report_file) as f:
+                report = json.load(f)
+        finally:
+            os.remove(report_file)
+
+        for case in report["cases"]:
+            phases = samples.setdefault(case["name"], {})
+            for phase, seconds in case["phases"].items():
+                phases.setdefault(phase, []).append(seconds)
+            phases.setdefault("total", []).append(case["total"])
+            n_dofs[case["name"]] = case["n_dofs"]
+    return samples, n_dofs
+
+
+def load_baseline(file_name):
+    """Accepts both the files written with --update-baseline and plain benchmark reports"""
+    with open(file_name) as f:
+        data = json.load(f)
+
+    if "samples" in data:
+        return data["samples"], data.get("n_dofs", {}), data.get("cases")
+
+    samples = {}
+    n_dofs = {}
+    for case in data["cases"]:
+        phases = {phase: [seconds] for phase, seconds in case["phases"].items()}
+        phases["total"] = [case["total"]]
+        samples[case["name"]] = phases
+        n_dofs[case["name"]] = case["n_dofs"]
+    return samples, n_dofs, None
+
+
+def compare(baseline, current, baseline_dofs, current_dofs, args):
+    """Prints the comparison table; returns the number of regressed phases"""
+    n_regressions = 0
+    print("%-32s %-9s %10s %10s %10s %8s  %s" %
+          ("case", "phase", "base", "median", "limit", "change", "status"))
+
+    for case in sorted(current):
+        if case not in baseline:
+            print("%-32s not in the baseline, skipped" % case)
+            continue
+        if case in baseline_dofs and baseline_dofs[case] != current_dofs.get(case):
+            print("%-32s dofs changed (%s -> %s), timings are not comparable, skipped" %
+                  (case, baseline_dofs[case], current_dofs.get(case)))
+            continue
+
+        for phase in sorted(current[case]):
+            if phase not in baseline[case]:
+                continue
+            base_median, base_noise = median_mad(baseline[case][phase])
+            median, noise = median_mad(current[case][phase])
+
+            limit = base_median + max(args.threshold * max(base_noise, noise),
+                                      args.rel_floor * base_median, args.abs_floor)
+            change = (median - base_median) / base_median if base_median > 0 else 0.0
+
+            if median > limit:
+                status = "REGRESSION"
+                n_regressions += 1
+            elif median < base_median - max(args.threshold * max(base_noise, noise),
+                                            args.rel_floor * base_median, args.abs_floor):
+                status = "improved"
+            else:
+                status = "ok"
+
+            print("%-32s %-9s %10.4f %10.4f %10.4f %+7.1f%%  %s" %
+                  (case, phase, base_median, median, limit, 100.0 * change, status))
+    return n_regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Performance regression gate for the benchmark suite")
+    parser.add_argument("baseline", nargs="?", help="baseline JSON to compare against")
+    parser.add_argument("--update-baseline", metavar="FILE", help="record a new baseline instead of comparing")
+    parser.add_argument("--benchmark", default="./benchmark", help="benchmark executable")
+    parser.add_argument("--res", default="../res", help="res/ directory with the meshes")
+    parser.add_argument("--cases", default=None,
+                        help="comma separated mesh pairs to run, e.g. 2d_aligned,3d_0 (default: from the baseline or all)")
+    parser.add_argument("--runs", type=int, default=5, help="number of benchmark runs")
+    parser.add_argument("--threshold", type=float, default=3.0,
+                        help="allowed slowdown in units of the scaled MAD")
+    parser.add_argument("--rel-floor", type=float, default=0.05,
+                        help="relative slowdown that is always tolerated")
+    parser.add_argument("--abs-floor", type=float, default=0.005,
+                        help="slowdown in seconds that is always tolerated")
+    args = parser.parse_args()
+
+    if args.update_baseline:
+        samples, n_dofs = run_benchmark(args.benchmark, args.res, args.cases, args.runs)
+        with open(args.update_baseline, "w") as f:
+            json.dump({"cases": args.cases, "runs": args.runs, "n_dofs": n_dofs, "samples": samples},
+                      f, indent=2, sort_keys=True)
+        print("Baseline with %d runs written to %s" % (args.runs, args.update_baseline))
+        return 0
+
+    if not args.baseline:
+        parser.error("baseline file or --update-baseline is required")
+
+    baseline, baseline_dofs, baseline_cases = load_baseline(args.baseline)
+    cases = args.cases if args.cases is not None else baseline_cases
+
+    current, current_dofs = run_benchmark(args.benchmark, args.res, cases, args.runs)
+    n_regressions = compare(baseline, current, baseline_dofs, current_dofs, args)
+
+    if n_regressions > 0:
+        print("%d phase(s) regressed" % n_regressions)
+        return 1
+    print("No regressions")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
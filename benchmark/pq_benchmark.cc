@@ -0,0 +1,296 @@
+/*
+ * pq_benchmark.cc
+ *
+ *  Created on: Oct 17, 2026
+ *
+ *  Microbenchmark of the PhysicalQuantities interpolation kernels.
+ *  Every kernel is timed on random and on sorted (field, temperature) inputs and its results
+ *  are checked against a plain reference implementation working on independently loaded tables.
+ *
+ *  Usage: pq_benchmark [res_dir] [n_samples] [repetitions]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "physical_quantities.h"
+
+namespace {
+
+typedef std::vector<std::pair<double, double> > Table;
+
+/** Uniform 2d grid as stored in the compact data files; v[i*ynum + j] */
+struct Grid {
+    std::vector<double> v;
+    double xmin = 0, xmax = 0, ymin = 0, ymax = 0;
+    unsigned xnum = 0, ynum = 0;
+};
+
+bool load_grid(const std::string &file_name, Grid &grid) {
+    std::ifstream infile(file_name);
+    if (!infile)
+        return false;
+
+    std::string line;
+    int line_counter = 0;
+    while (std::getline(infile, line)) {
+        if (line.empty() || line[0] == '%'
+                || line.find_first_of("0123456789") == std::string::npos)
+            continue;
+        std::istringstream stm(line);
+        if (line_counter == 0) {
+            stm >> grid.xmin >> grid.xmax >> grid.xnum;
+        } else if (line_counter == 1) {
+            stm >> grid.ymin >> grid.ymax >> grid.ynum;
+        } else {
+            double val;
+            stm >> val;
+            grid.v.push_back(val);
+        }
+        line_counter++;
+    }
+    return grid.v.size() == grid.xnum * grid.ynum && grid.xnum > 1 && grid.ynum > 1;
+}
+
+bool load_table(const std::string &file_name, Table &table) {
+    std::ifstream infile(file_name);
+    if (!infile)
+        return false;
+    double x, y;
+    while (infile >> x >> y)
+        table.push_back(std::make_pair(x, y));
+    return table.size() > 1;
+}
+
+// ----------------------------------------------------------------------------------------
+// Reference implementations: the definitions of the interpolations written out plainly
+
+double ref_linear_interp(double x, const Table &data) {
+    if (x <= data.front().first)
+        return data.front().second;
+    if (x >= data.back().first)
+        return data.back().second;
+    unsigned int i = 1;
+    while (data[i].first < x)
+        ++i;
+    const double w = (x - data[i - 1].first) / (data[i].first - data[i - 1].first);
+    return data[i - 1].second + w * (data[i].second - data[i - 1].second);
+}
+
+double ref_node_derivative(const Table &data, const unsigned int i) {
+    const unsigned int lo = i == 0 ? 0 : i - 1;
+    const unsigned int hi = i + 1 == data.size() ? i : i + 1;
+    return (data[hi].second - data[lo].second) / (data[hi].first - data[lo].first);
+}
+
+double ref_deriv_linear_interp(double x, const Table &data) {
+    if (x <= data.front().first)
+        x = data.front().first + 1e-10;
+    if (x >= data.back().first)
+        x = data.back().first;
+    unsigned int i = 1;
+    while (data[i].first < x)
+        ++i;
+    const double w = (x - data[i - 1].first) / (data[i].first - data[i - 1].first);
+    const double d0 = ref_node_derivative(data, i - 1);
+    const double d1 = ref_node_derivative(data, i);
+    return d0 + w * (d1 - d0);
+}
+
+double ref_bilinear_interp(double x, double y, const Grid &g) {
+    const double eps = 1e-10;
+    x = std::min(std::max(x, g.xmin), g.xmax - eps);
+    y = std::min(std::max(y, g.ymin), g.ymax - eps);
+    const double sx = (x - g.xmin) / ((g.xmax - g.xmin) / (g.xnum - 1));
+    const double sy = (y - g.ymin) / ((g.ymax - g.ymin) / (g.ynum - 1));
+    const int xi = int(sx), yi = int(sy);
+    const double xc = sx - xi, yc = sy - yi;
+    const double v00 = g.v[xi * g.ynum + yi], v01 = g.v[xi * g.ynum + yi + 1];
+    const double v10 = g.v[(xi + 1) * g.ynum + yi], v11 = g.v[(xi + 1) * g.ynum + yi + 1];
+    return (1 - xc) * ((1 - yc) * v00 + yc * v01) + xc * ((1 - yc) * v10 + yc * v11);
+}
+
+double clamp_temperature(double t) {
+    return std::min(std::max(t, 200.0), 1400.0);
+}
+
+struct Reference {
+    Grid emission, nottingham;
+    Table resistivity_table;
+
+    double emission_current(double f, double t) const {
+        return std::exp(ref_bilinear_interp(std::log(f), t, emission)) * 1.0e-20;
+    }
+    double nottingham_de(double f, double t) const {
+        return ref_bilinear_interp(std::log(f), t, nottingham);
+    }
+    double resistivity(double t) const {
+        return ref_linear_interp(t, resistivity_table) * 1.0e10;
+    }
+    double resistivity_derivative(double t) const {
+        return ref_deriv_linear_interp(t, resistivity_table) * 1.0e10;
+    }
+    double sigma(double t) const {
+        return 1.0 / resistivity(clamp_temperature(t));
+    }
+    double dsigma(double t) const {
+        t = clamp_temperature(t);
+        const double rho = resistivity(t);
+        return -resistivity_derivative(t) / (rho * rho);
+    }
+    double kappa(double t) const {
+        t = clamp_temperature(t);
+        return 2.443e-8 * t * sigma(t);
+    }
+    double dkappa(double t) const {
+        t = clamp_temperature(t);
+        return 2.443e-8 * (sigma(t) + t * dsigma(t));
+    }
+};
+
+// ----------------------------------------------------------------------------------------
+
+typedef std::function<double(double, double)> Kernel;
+
+/** Kernel under test and its reference */
+struct KernelCase {
+    std::string name;
+    Kernel kernel;
+    Kernel reference;
+};
+
+struct Result {
+    double ns_per_call;
+    double max_rel_error;
+};
+
+/** Best of the repetitions; the values are summed into a sink so that the calls are not optimised away */
+Result run_kernel(const Kernel &kernel, const Kernel &reference,
+        const std::vector<std::pair<double, double> > &inputs, const unsigned int repetitions) {
+    static volatile double sink = 0.0;
+
+    double best = 1e300;
+    for (unsigned int r = 0; r < repetitions; ++r) {
+        double sum = 0.0;
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned int i = 0; i < inputs.size(); ++i)
+            sum += kernel(inputs[i].first, inputs[i].second);
+        const auto stop = std::chrono::steady_clock::now();
+        sink = sink + sum;
+        best = std::min(best, std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+
+    // errors are relative to the value, with a floor for the kernels that cross zero
+    double max_abs_reference = 0.0;
+    for (unsigned int i = 0; i < inputs.size(); ++i)
+        max_abs_reference = std::max(max_abs_reference,
+                std::abs(reference(inputs[i].first, inputs[i].second)));
+
+    double max_rel_error = 0.0;
+    for (unsigned int i = 0; i < inputs.size(); ++i) {
+        const double value = kernel(inputs[i].first, inputs[i].second);
+        const double expected = reference(inputs[i].first, inputs[i].second);
+        const double scale = std::max(std::abs(expected), 1e-6 * max_abs_reference);
+        max_rel_error = std::max(max_rel_error, std::abs(value - expected) / std::max(scale, 1e-300));
+    }
+
+    Result result;
+    result.ns_per_call = best / inputs.size();
+    result.max_rel_error = max_rel_error;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const std::string res_path = argc > 1 ? argv[1] : "../res";
+    const unsigned int n_samples = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    const unsigned int repetitions = argc > 3 ? std::atoi(argv[3]) : 5;
+    const double tolerance = 1e-12;   ///< allowed relative deviation from the reference
+
+    const std::string emission_file = res_path + "/physical_quantities/gtf_200x200.dat";
+    const std::string nottingham_file = res_path + "/physical_quantities/nottingham_200x200.dat";
+    const std::string resistivity_file = res_path + "/physical_quantities/cu_res.dat";
+
+    fch::PhysicalQuantities pq;
+    Reference ref;
+    if (!(pq.load_emission_data(emission_file) && pq.load_nottingham_data(nottingham_file)
+            && pq.load_resistivity_data(resistivity_file) && load_grid(emission_file, ref.emission)
+            && load_grid(nottingham_file, ref.nottingham)
+            && load_table(resistivity_file, ref.resistivity_table))) {
+        std::cout << "Couldn't load pq data from " << res_path << ". Exiting..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Inputs cover the tabulated range plus some extrapolation on both sides
+    std::mt19937_64 generator(12345);
+    std::uniform_real_distribution<double> log_field(std::log(0.05), std::log(20.0));
+    std::uniform_real_distribution<double> temperature(150.0, 2100.0);
+
+    std::vector<std::pair<double, double> > random_inputs(n_samples);
+    for (unsigned int i = 0; i < n_samples; ++i)
+        random_inputs[i] = std::make_pair(std::exp(log_field(generator)), temperature(generator));
+    std::vector<std::pair<double, double> > sorted_inputs = random_inputs;
+    std::sort(sorted_inputs.begin(), sorted_inputs.end());
+
+    const std::vector<KernelCase> kernels = {
+        { "emission_current (bilinear_interp)",
+            [&pq](double f, double t) {return pq.emission_current(f, t);},
+            [&ref](double f, double t) {return ref.emission_current(f, t);} },
+        { "nottingham_de (bilinear_interp)",
+            [&pq](double f, double t) {return pq.nottingham_de(f, t);},
+            [&ref](double f, double t) {return ref.nottingham_de(f, t);} },
+        { "evaluate_resistivity (linear_interp)",
+            [&pq](double, double t) {return pq.evaluate_resistivity(t);},
+            [&ref](double, double t) {return ref.resistivity(t);} },
+        { "evaluate_resistivity_derivative (deriv_linear_interp)",
+            [&pq](double, double t) {return pq.evaluate_resistivity_derivative(t);},
+            [&ref](double, double t) {return ref.resistivity_derivative(t);} },
+        { "sigma",
+            [&pq](double, double t) {return pq.sigma(t);},
+            [&ref](double, double t) {return ref.sigma(t);} },
+        { "dsigma",
+            [&pq](double, double t) {return pq.dsigma(t);},
+            [&ref](double, double t) {return ref.dsigma(t);} },
+        { "kappa",
+            [&pq](double, double t) {return pq.kappa(t);},
+            [&ref](double, double t) {return ref.kappa(t);} },
+        { "dkappa",
+            [&pq](double, double t) {return pq.dkappa(t);},
+            [&ref](double, double t) {return ref.dkappa(t);} }
+    };
+
+    std::printf("PhysicalQuantities microbenchmark: %u samples, best of %u repetitions\n",
+            n_samples, repetitions);
+    std::printf("%-56s %-7s %10s %14s %12s\n", "kernel", "inputs", "ns/call", "calls/s", "max_rel_err");
+
+    bool all_passed = true;
+    for (unsigned int k = 0; k < kernels.size(); ++k) {
+        for (int sorted = 0; sorted <= 1; ++sorted) {
+            const Result r = run_kernel(kernels[k].kernel, kernels[k].reference,
+                    sorted ? sorted_inputs : random_inputs, repetitions);
+            const bool passed = r.max_rel_error <= tolerance;
+            all_passed = all_passed && passed;
+            std::printf("%-56s %-7s %10.2f %14.4e %12.2e%s\n", kernels[k].name.c_str(),
+                    sorted ? "sorted" : "random", r.ns_per_call, 1e9 / r.ns_per_call,
+                    r.max_rel_error, passed ? "" : "  MISMATCH");
+        }
+    }
+
+    if (!all_passed) {
+        std::cout << "Some kernels deviate from the reference by more than " << tolerance << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
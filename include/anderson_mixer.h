@@ -0,0 +1,60 @@
+/*
+ * anderson_mixer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_ANDERSON_MIXER_H_
+#define INCLUDE_ANDERSON_MIXER_H_
+
+#include <deal.II/lac/vector.h>
+
+#include <deque>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Anderson acceleration of the fixed point iteration x = G(x).
+ *
+ * The next iterate is the combination of the last depth+1 iterates that minimises the
+ * linearised residual G(x) - x in the least squares sense. With depth 0 it reduces to
+ * the simple mixing x_new = (1 - mixing) * x + mixing * G(x).
+ */
+class AndersonMixer {
+public:
+    /**
+     * @param depth   number of previous iterates used in the extrapolation
+     * @param mixing  damping factor applied to the residual, 1.0 means no damping
+     */
+    AndersonMixer(const unsigned int depth = 5, const double mixing = 1.0);
+
+    /** Change the parameters and forget the history */
+    void reinit(const unsigned int depth, const double mixing);
+
+    /** Forget the history of the previous iterates */
+    void clear();
+
+    /**
+     * Calculate the next iterate
+     * @param x  current iterate on input, next iterate on output
+     * @param g  value of G(x) for the current iterate
+     */
+    void update(Vector<double> &x, const Vector<double> &g);
+
+private:
+    unsigned int depth;
+    double mixing;
+
+    std::deque<Vector<double> > delta_f;  ///< differences of the consecutive residuals
+    std::deque<Vector<double> > delta_g;  ///< differences of the consecutive G(x)
+
+    Vector<double> residual;              ///< G(x) - x of the current iterate
+    Vector<double> previous_residual;
+    Vector<double> previous_g;
+    bool has_previous;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_ANDERSON_MIXER_H_ */
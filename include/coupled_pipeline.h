@@ -0,0 +1,123 @@
+/*
+ * coupled_pipeline.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_COUPLED_PIPELINE_H_
+#define INCLUDE_COUPLED_PIPELINE_H_
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "laplace.h"
+#include "currents_and_heating_stationary.h"
+#include "physical_quantities.h"
+#include "solver_stats.h"
+#include "solver_worker.h"
+#include "trace_recorder.h"
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Driver of the coupled stationary iterations that overlaps the independent stages of consecutive steps.
+ *
+ * Every step n consists of four stages, which run as soon as their dependencies are ready:
+ * - field(n): import the vacuum mesh, set up, assemble and solve the Laplace equation;
+ * - copper(n): import and set up the copper mesh;
+ * - newton(n): stationary currents and heating with the initial condition interpolated from step n-1;
+ *   needs field(n), copper(n) and newton(n-1);
+ * - output(n): write the field and temperature solutions; needs newton(n).
+ *
+ * So field(n+1) and copper(n+1) run together with newton(n), and output(n) runs with newton(n+1),
+ * and a step costs about as much as its slowest stage. Each kind of stage has one worker thread that
+ * runs the stages of the steps in order, so the pipeline uses four threads however many steps are added.
+ * To bound the memory, field(n) and copper(n) do not import their meshes before newton(n-2) is done.
+ * Every step has its own solvers, created empty when the step is added and freed after the output
+ * of the next step.
+ * Exceptions of a stage are rethrown by the futures of the step.
+ */
+template<int dim>
+class CoupledPipeline {
+public:
+    /** Input files and field of a step */
+    struct StepInput {
+        std::string vacuum_mesh;        ///< vacuum mesh file
+        std::string copper_mesh;        ///< copper mesh file
+        double applied_efield = 1.0;    ///< applied field [V/nm]
+        std::string field_output;       ///< file of the field solution; empty for no output
+        std::string solution_output;    ///< file of the potential and temperature solution; empty for no output
+    };
+
+    /** Statistics of a step */
+    struct StepResult {
+        unsigned int step = 0;
+        SolveStats field;               ///< Laplace solve
+        NewtonStats heating;            ///< stationary currents and heating
+        double field_time = 0.0;        ///< wall time of the field stage [s]
+        double copper_time = 0.0;       ///< wall time of the copper stage [s]
+        double output_time = 0.0;       ///< wall time of the output stage [s]
+    };
+
+    /** @param pq_ physical quantities used by all the steps; must outlive the pipeline */
+    CoupledPipeline(PhysicalQuantities *pq_);
+
+    /** Waits for all the stages */
+    ~CoupledPipeline();
+
+    /** Parameters of the Newton iterations of the steps added afterwards (see run_specific) */
+    void set_newton_parameters(const double temperature_tolerance, const int max_newton_iter = 100,
+            const double sor_alpha = 1.0);
+
+    /** Records the stages ("pipeline_field" etc) and the solver phases of the steps added afterwards */
+    void set_trace_recorder(TraceRecorder *recorder);
+
+    /**
+     * Starts the stages of the next step as soon as their dependencies allow
+     * @return future of the step statistics, ready after its output stage
+     */
+    std::shared_future<StepResult> add_step(const StepInput &input);
+
+    /** Adds the steps and waits for all of them; rethrows the first exception of the stages */
+    std::vector<StepResult> run(const std::vector<StepInput> &inputs);
+
+    /** Waits until all the stages of the added steps are finished */
+    void wait() const;
+
+private:
+    /** Solvers and stages of a step */
+    struct Step {
+        std::unique_ptr<Laplace<dim> > laplace;
+        std::unique_ptr<CurrentsAndHeatingStationary<dim> > ch;
+        double field_time = 0.0;
+        double copper_time = 0.0;
+
+        std::shared_future<SolveStats> field;
+        std::shared_future<void> copper;
+        std::shared_future<NewtonStats> newton;
+        std::shared_future<StepResult> output;
+    };
+
+    PhysicalQuantities *pq;
+    TraceRecorder *tracer;
+
+    double temperature_tolerance;
+    int max_newton_iter;
+    double sor_alpha;
+
+    std::deque<Step> steps;         ///< deque keeps the steps in place when new ones are added
+
+    // Stage threads; last members, so they finish the queued stages before the steps are destroyed
+    SolverWorker field_worker;
+    SolverWorker copper_worker;
+    SolverWorker newton_worker;
+    SolverWorker output_worker;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_COUPLED_PIPELINE_H_ */
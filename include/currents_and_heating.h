@@ -14,14 +14,29 @@
 #include <deal.II/fe/fe_q.h>
 #include <deal.II/fe/fe_system.h>
 #include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/fe/fe_values.h>
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <tuple>
 
 #include "mesh_preparer.h"
 #include "physical_quantities.h"
 #include "laplace.h"
+#include "heat_operator.h"
+#include "element_kernels.h"
+#include "mixed_precision.h"
+#include "memory_report.h"
+#include "trace_recorder.h"
+#include "solver_stats.h"
+#include "ssor_tuner.h"
+#include "solver_worker.h"
 
 namespace fch {
 
@@ -40,6 +55,9 @@ template<int dim>
 class CurrentsAndHeating {
 public:
 
+    /** Called on the solving thread after every time step with the number of steps done and the step statistics */
+    typedef std::function<void(const unsigned int step, const StepStats &stats)> StepProgress;
+
     /**
      * Constructor for CurrentsAndHeating
      * Physical quantities will be set as NULL and default timestep will be used,
@@ -99,20 +117,54 @@ public:
      * @param pc_ssor flag to use SSOR preconditioner
      * @param ssor_param   parameter to SSOR preconditioner. 1.2 is known to work well with laplace.
      *                     its fine tuning optimises calculation time
+     * @return CG iterations, residual history and wall time of the solve
      */
-    unsigned int solve_current(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
+    SolveStats solve_current(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
             double ssor_param = 1.2);
 
     /** solves the matrix equation for temperature calculations using conjugate gradient method
+     * If the system was assembled matrix-free, Chebyshev-Jacobi preconditioner is used instead of SSOR.
      * @param max_iter maximum number of iterations allowed
      * @param tol tolerance of the solution
-     * @param pc_ssor flag to use SSOR preconditioner
+     * @param pc_ssor flag to use SSOR (or Chebyshev-Jacobi in matrix-free case) preconditioner
      * @param ssor_param   parameter to SSOR preconditioner. 1.2 is known to work well with laplace.
      *                     its fine tuning optimises calculation time
+     * @return CG iterations, residual history and wall time of the solve
      */
-    unsigned int solve_heat(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
+    SolveStats solve_heat(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
             double ssor_param = 1.2);
 
+    /** Advances the solution by one time step: assembles and solves the current and then the heat equation.
+     * The parameters of the linear solves are the same as in solve_current() and solve_heat().
+     * @param euler_implicit  integrate the heat equation with implicit Euler instead of Crank-Nicolson,
+     *                        e.g. in the first step
+     * @return statistics of the solves, assembly times and the peak temperature after the step
+     */
+    StepStats do_time_step(const bool euler_implicit = false, int max_iter = 2000, double tol = 1e-9,
+            bool pc_ssor = true, double ssor_param = 1.2);
+
+    /** Does n_steps time steps, stopping early if the cancellation token is set before a step.
+     * @param euler_implicit_first  integrate the first step with implicit Euler and the rest with Crank-Nicolson
+     * @return statistics of the completed steps
+     */
+    std::vector<StepStats> do_time_steps(const unsigned int n_steps, const bool euler_implicit_first = false,
+            int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true, double ssor_param = 1.2);
+
+    /** Starts do_time_step on the worker thread of the solver; the solver must not be used until the future is ready */
+    std::future<StepStats> do_time_step_async(const bool euler_implicit = false, int max_iter = 2000,
+            double tol = 1e-9, bool pc_ssor = true, double ssor_param = 1.2);
+
+    /** Starts do_time_steps on the worker thread of the solver; the solver must not be used until the future is ready */
+    std::future<std::vector<StepStats> > do_time_steps_async(const unsigned int n_steps,
+            const bool euler_implicit_first = false, int max_iter = 2000, double tol = 1e-9,
+            bool pc_ssor = true, double ssor_param = 1.2);
+
+    /** Sets the function called after every time step; empty function disables it */
+    void set_progress_callback(StepProgress callback);
+
+    /** Sets the token that stops do_time_steps before the next step. NULL (default) disables the check. */
+    void set_cancellation_token(const CancellationToken *token);
+
     /** Output the electric potential [V] and field [V/nm] to a specified file in vtk format */
     void output_results_current(const std::string filename = "current_solution.vtk") const;
 
@@ -130,10 +182,42 @@ public:
      */
     void set_electric_field_bc(const std::vector<double> &e_fields);
 
+    /** Set the electric field boundary condition on copper-vacuum boundary without copying the values.
+     * The array holds a value for every face in the order of get_surface_nodes() and it must stay valid
+     * until the boundary condition is set again (e.g. a SharedSurfaceChannel frame).
+     */
+    void set_electric_field_bc(const double *e_fields);
+
     /** Set the electric field boundary condition on copper-vacuum boundary.
      * The electric field on every face will be the same. */
     void set_electric_field_bc(const double uniform_efield);
 
+    /** Use the matrix-free operator in the Crank-Nicolson heat equation.
+     * In that case assemble_heating_system_crank_nicolson() assembles only the right-hand side
+     * and evaluates kappa(T) in the quadrature points, and solve_heat() applies the operator cell-wise.
+     */
+    void set_matrix_free_heating(const bool enable);
+
+    /** Selects the mixed precision mode of the SSOR preconditioned CG in solve_current() and solve_heat().
+     * MixedPrecisionCG::off (default) keeps the solves in double precision.
+     * The matrix-free heating solve is not affected.
+     */
+    void set_mixed_precision(const MixedPrecisionCG::Mode mode);
+
+    /**
+     * Enables tuning the SSOR relaxation parameters of the current and heat matrices separately
+     * during the time steps (see SSORTuner). While enabled, the ssor_param arguments of
+     * solve_current() and solve_heat() are ignored; the used values are in SolveStats::ssor_param.
+     * The matrix-free heat solve uses Chebyshev smoothing and is not tuned.
+     */
+    void set_ssor_autotuning(const bool enable);
+
+    /**
+     * Records the setup, assembly, solve and output phases and the CG iterations (ccg, hcg)
+     * into the recorder. NULL (default) disables the tracing.
+     */
+    void set_trace_recorder(TraceRecorder *recorder);
+
     /** Set timestep of time domain integration [sec] */
     void set_timestep(const double time_step_);
 
@@ -144,6 +228,12 @@ public:
     void set_emission_bc(const std::vector<double> &emission_currents,
             const std::vector<double> &nottingham_heats);
 
+    /** Set the emission current and Nottingham boundary condition without copying the values.
+     * The arrays follow the face order of get_surface_nodes() and must stay valid until the
+     * boundary condition is set again.
+     */
+    void set_emission_bc(const double *emission_currents, const double *nottingham_heats);
+
     /** Sets the physical quantities object */
     void set_physical_quantities(PhysicalQuantities *pq_);
 
@@ -168,6 +258,17 @@ public:
     /** export the centroids of surface faces */
     void get_surface_nodes(std::vector<Point<dim>>& nodes);
 
+    /** Number of copper surface faces, i.e. the length of the surface arrays */
+    unsigned int get_n_surface_faces() const {
+        return surface_face_index.size();
+    }
+
+    /**
+     * Write the average temperature of the vertices of every surface face into an array
+     * in the order of get_surface_nodes(), e.g. into a SharedSurfaceChannel frame
+     */
+    void get_surface_temperatures(double *temperatures) const;
+
     double get_max_temperature();
 
     /** Provide triangulation object to get access to the mesh data */
@@ -179,6 +280,21 @@ public:
     /** Get the temperature at the specified point. NB: Slow! */
     double probe_temperature(const Point<dim> &p) const;
 
+    /**
+     * Memory used by the mesh, dofs, matrices, vectors and solver data of both systems,
+     * together with the peak resident memory of the process after every phase
+     */
+    MemoryReport get_memory_report() const;
+
+    /** Print the statistics about the mesh, # degrees of freedom and memory usage */
+    friend std::ostream& operator <<(std::ostream &os, const CurrentsAndHeating<dim>& d) {
+        os << "#elems=" << d.triangulation.n_active_cells() << ",\t#nodes="
+                << d.triangulation.n_used_vertices() << ",\t#dofs_current="
+                << d.dof_handler_current.n_dofs() << ",\t#dofs_heat="
+                << d.dof_handler_heat.n_dofs() << "\n" << d.get_memory_report();
+        return os;
+    }
+
 private:
 
     double get_efield_bc(std::pair<unsigned, unsigned> cop_cell_info);
@@ -192,6 +308,68 @@ private:
 
     static constexpr double cu_rho_cp = 3.4496e-24;    ///< volumetric heat capacity of copper J/(K*ang^3)
 
+    /** Persistent workspace of assemble_current_system, created in setup_current_system */
+    struct CurrentScratch {
+        CurrentScratch(const FE_Q<dim> &fe_current, const FE_Q<dim> &fe_heat) :
+                quadrature(currents_degree + 1), face_quadrature(currents_degree + 1),
+                fe_values(fe_current, quadrature,
+                        update_gradients | update_quadrature_points | update_JxW_values),
+                fe_face_values(fe_current, face_quadrature,
+                        update_values | update_quadrature_points | update_JxW_values),
+                fe_values_heat(fe_heat, quadrature, update_values),
+                fe_face_values_heat(fe_heat, face_quadrature, update_values),
+                local_dof_indices(fe_current.dofs_per_cell),
+                temperature_values(quadrature.size()),
+                face_temperature_values(face_quadrature.size()) {
+        }
+        QGauss<dim> quadrature;
+        QGauss<dim - 1> face_quadrature;
+        FEValues<dim> fe_values;
+        FEFaceValues<dim> fe_face_values;
+        FEValues<dim> fe_values_heat;           ///< for accessing the temperature
+        FEFaceValues<dim> fe_face_values_heat;
+        ElementKernel<dim, currents_degree> kernel;
+        std::vector<types::global_dof_index> local_dof_indices;
+        std::vector<double> temperature_values;
+        std::vector<double> face_temperature_values;
+    };
+
+    typedef PreconditionChebyshev<HeatOperator<dim, heating_degree>, Vector<double> > HeatChebyshev;
+
+    /** Persistent workspace of the heating assemblers and solver, created in setup_heating_system */
+    struct HeatScratch {
+        HeatScratch(const FE_Q<dim> &fe_heat, const FE_Q<dim> &fe_current) :
+                quadrature(heating_degree + 1), face_quadrature(heating_degree + 1),
+                fe_values(fe_heat, quadrature,
+                        update_values | update_gradients | update_quadrature_points | update_JxW_values),
+                fe_face_values(fe_heat, face_quadrature,
+                        update_values | update_quadrature_points | update_JxW_values),
+                fe_values_current(fe_current, quadrature, update_gradients),
+                local_dof_indices(fe_heat.dofs_per_cell),
+                potential_gradients(quadrature.size()),
+                prev_potential_gradients(quadrature.size()),
+                temperature_values(quadrature.size()),
+                temperature_gradients(quadrature.size()),
+                face_temperature_values(face_quadrature.size()) {
+        }
+        QGauss<dim> quadrature;
+        QGauss<dim - 1> face_quadrature;
+        FEValues<dim> fe_values;
+        FEFaceValues<dim> fe_face_values;
+        FEValues<dim> fe_values_current;        ///< for accessing the potential
+        ElementKernel<dim, heating_degree> kernel;
+        std::vector<types::global_dof_index> local_dof_indices;
+        std::vector<Tensor<1, dim>> potential_gradients;
+        std::vector<Tensor<1, dim>> prev_potential_gradients;
+        std::vector<double> temperature_values;
+        std::vector<Tensor<1, dim>> temperature_gradients;
+        std::vector<double> face_temperature_values;
+
+        Vector<double> lifted_rhs;              ///< matrix-free Dirichlet lifting of the rhs
+        Vector<double> homogeneous_solution;    ///< matrix-free solution without the Dirichlet values
+        typename HeatChebyshev::AdditionalData chebyshev_data;  ///< its inverse diagonal is updated in place
+    };
+
     double time_step;
 
     double uniform_efield_bc;
@@ -201,6 +379,7 @@ private:
     // Current specific variables
     FE_Q<dim> fe_current;
     DoFHandler<dim> dof_handler_current;
+    ConstraintMatrix current_constraints;   ///< zero potential at the copper bottom
     SparsityPattern sparsity_pattern_current;
     SparseMatrix<double> system_matrix_current;
     Vector<double> system_rhs_current;
@@ -208,9 +387,12 @@ private:
     Vector<double> solution_current;
     Vector<double> old_solution_current;
 
+    std::unique_ptr<CurrentScratch> current_scratch;
+
     // Heating specific variables
     FE_Q<dim> fe_heat;
     DoFHandler<dim> dof_handler_heat;
+    ConstraintMatrix heat_constraints;      ///< ambient temperature at the copper bottom
     SparsityPattern sparsity_pattern_heat;
     SparseMatrix<double> system_matrix_heat;
     Vector<double> system_rhs_heat;
@@ -218,9 +400,33 @@ private:
     Vector<double> solution_heat;
     Vector<double> old_solution_heat;
 
+    // Matrix-free heating variables
+    bool matrix_free_heating;               ///< use the matrix-free operator in Crank-Nicolson steps
+    bool heat_system_matrix_free;           ///< the last assembled heating system is the matrix-free one
+    HeatOperator<dim, heating_degree> heat_operator;
+    Vector<double> heat_lift;               ///< Dirichlet temperature on the constrained dofs, 0 elsewhere
+
+    std::unique_ptr<HeatScratch> heat_scratch;
+
+    // Linear solvers and preconditioners kept between the time steps
+    HistorySolverControl solver_control;
+    SolverCG<> solver_cg;
+    PreconditionSSOR<> preconditioner_ssor;
+    HeatChebyshev preconditioner_chebyshev;
+
+    bool ssor_autotuning;                   ///< choose the SSOR parameters with the tuners
+    SSORTuner ssor_tuner_current;
+    SSORTuner ssor_tuner_heat;
+
+    MixedPrecisionCG::Mode mixed_precision;
+    MixedPrecisionCG mixed_precision_cg_current;  ///< keeps the float copy of the current matrix
+    MixedPrecisionCG mixed_precision_cg_heat;     ///< keeps the float copy of the heating matrix
 
     PhysicalQuantities *pq;
 
+    mutable MemoryReport memory_report;     ///< peak resident memory after the phases
+    TraceRecorder *tracer;                  ///< timeline of the phases, NULL if disabled
+
     /** Mapping of copper interface faces to vacuum side e field norm
      * (copper_cell_index, copper_cell_face) <-> (electric field norm)
      */
@@ -231,6 +437,22 @@ private:
      */
      std::map<std::pair<unsigned, unsigned>, double> interface_map_emission_current;
      std::map<std::pair<unsigned, unsigned>, double> interface_map_nottingham;
+
+    /** Position of the copper interface faces in the surface arrays
+     * (copper_cell_index, copper_cell_face) <-> (index in the order of get_surface_nodes)
+     */
+    std::map<std::pair<unsigned, unsigned>, unsigned> surface_face_index;
+
+    /** External boundary condition arrays in the surface face order, NULL if the maps are used */
+    const double *efield_array;
+    const double *emission_current_array;
+    const double *nottingham_array;
+
+    unsigned int n_time_steps;              ///< time steps done since the construction
+    StepProgress progress_callback;         ///< called after every time step, may be empty
+    const CancellationToken *cancellation;  ///< stops do_time_steps, NULL if disabled
+
+    SolverWorker worker;                    ///< runs the async solves; last member, so it is joined first
 };
 
 } // end fch namespace
@@ -13,15 +13,29 @@
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/fe/fe_q.h>
 #include <deal.II/fe/fe_system.h>
+#include <deal.II/fe/fe_values.h>
 #include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/sparse_direct.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/base/aligned_vector.h>
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/base/timer.h>
+#include <deal.II/base/vectorization.h>
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <tuple>
 
 #include "mesh_preparer.h" // for BoundaryId-s.. probably should think of a better place for them
 #include "physical_quantities.h"
 #include "laplace.h"
+#include "memory_report.h"
+#include "trace_recorder.h"
+#include "solver_stats.h"
+#include "solver_worker.h"
 
 namespace fch {
 
@@ -41,6 +55,9 @@ template<int dim>
 class CurrentsAndHeatingStationary {
 public:
 
+    /** Called on the solving thread after every Newton iteration with the statistics so far */
+    typedef std::function<void(const NewtonStats &stats)> NewtonProgress;
+
     /**
      * Initializes the object
      * NB: pq and laplace will be set as NULL, so they must be set separately
@@ -86,8 +103,59 @@ public:
     /** Sets the ambient temperature boundary condition */
     void set_ambient_temperature(const double ambient_temperature_);
 
+    /**
+     * Sets the Jacobian reuse (chord / modified Newton) policy for run_specific.
+     * When enabled, the factorized Jacobian of the last full Newton iteration is kept and
+     * only the residual is reassembled. A fresh Jacobian is assembled and factorized
+     * when the contraction rate ||du_k|| / ||du_{k-1}|| exceeds max_contraction_rate.
+     * @param enable use the modified Newton iterations
+     * @param max_contraction_rate contraction rate above which the Jacobian is refreshed
+     */
+    void set_jacobian_reuse(bool enable, double max_contraction_rate = 0.5);
+
+    /**
+     * Enables partial Jacobian reassembly in the Newton iterations of run_specific.
+     * Local cell matrices and rhs vectors are cached together with the cell solution values they
+     * were built from. Only the cells where the solution changed more than the tolerances are
+     * recomputed and their difference to the cached contribution is added to the global system.
+     * @param temperature_tolerance maximum temperature change (K) in a cell for reusing its contribution;
+     *                              negative value disables the partial reassembly
+     * @param potential_rel_tolerance maximum relative potential change in a cell for reusing its contribution
+     */
+    void set_partial_reassembly(double temperature_tolerance, double potential_rel_tolerance = 1e-3);
+
+    /**
+     * Enables assembling the Newton system for batches of cells at once.
+     * The volume terms of VectorizedArray<double>::n_array_elements cells are evaluated
+     * in SIMD lanes and then scattered lane by lane. Not used together with the partial reassembly.
+     */
+    void set_batched_assembly(bool enable);
+
+    /**
+     * Starts run_specific from the solution of the previous run on the same mesh instead of the
+     * default or interpolated initial condition. The previous run must have converged;
+     * setup_system and a changed ambient temperature discard the solution.
+     */
+    void set_warm_start(bool enable);
+
+    /**
+     * Records the setup, interface mapping, initial condition, the assembly, factorization and
+     * solve of every Newton iteration and the output into the recorder, together with the Newton errors.
+     * NULL (default) disables the tracing.
+     */
+    void set_trace_recorder(TraceRecorder *recorder);
+
+    /** Sets the function called after every Newton iteration of run_specific; empty function disables it */
+    void set_progress_callback(NewtonProgress callback);
+
+    /**
+     * Sets the token that stops run_specific before the next Newton iteration.
+     * The statistics of the stopped run have cancelled set. NULL (default) disables the check.
+     */
+    void set_cancellation_token(const CancellationToken *token);
+
     /** runs the calculation with hardcoded parameters (mainly for testing) */
-    void run();
+    NewtonStats run();
 
     /**
      * Runs calculation with specific parameters
@@ -100,14 +168,30 @@ public:
      * @param sor_alpha successive over-relaxation coefficient
      * @param ic_interp_treshold peak temperature value of the previous iteration, which determines if interpolation is done
      * @param skip_field_mapping skip the (cell face) <-> (field) mapping on the surface; the field BC must be set by other means
-     * @return final temperature error
+     * @return Newton iterations, error and residual histories, phase times and peak temperature;
+     *         temperature_error is the final temperature error or -1 if the run could not be started
+     */
+    NewtonStats run_specific(double temperature_tolerance = 1.0,
+            int max_newton_iter = 10, bool file_output = true,
+            std::string out_fname = "sol", bool print = true,
+            double sor_alpha = 1.0, double ic_interp_treshold = 400,
+            bool skip_field_mapping = false);
+
+    /**
+     * Starts run_specific on the worker thread of the solver, with the same parameters.
+     * The solver and its Laplace solver must not be used until the future is ready.
      */
-    double run_specific(double temperature_tolerance = 1.0,
+    std::future<NewtonStats> run_specific_async(double temperature_tolerance = 1.0,
             int max_newton_iter = 10, bool file_output = true,
             std::string out_fname = "sol", bool print = true,
             double sor_alpha = 1.0, double ic_interp_treshold = 400,
             bool skip_field_mapping = false);
 
+    /** Number of Newton iterations done in the last run_specific */
+    int get_n_newton_iterations() const {
+        return n_newton_iterations;
+    }
+
     /** Provide triangulation object to get access to the mesh data */
     Triangulation<dim>* get_triangulation();
 
@@ -117,6 +201,12 @@ public:
     /** Return the solution vector with potential and temperature values */
     Vector<double>* get_solution();
 
+    /** Maximum nodal temperature of the present solution */
+    double get_max_temperature() const;
+
+    /** Total emission current through the copper surface; the field mapping must be set up (run_specific) */
+    double get_total_current() const;
+
     /**
      * Imports mesh from file and sets the boundary indicators corresponding to copper
      * @param file_name file from the mesh is imported
@@ -159,26 +249,146 @@ public:
             const std::vector<int> &cell_indexes,
             const std::vector<int> &vert_indexes);
 
-    /** string stream prints the statistics about the system */
+    /** string stream prints the statistics about the system and its memory usage */
     friend std::ostream& operator <<(std::ostream &os,
             const CurrentsAndHeatingStationary<dim>& d) {
         os << "#elems=" << d.triangulation.n_active_cells() << ",\t#faces="
                 << d.triangulation.n_active_faces() << ",\t#edges="
                 << d.triangulation.n_active_lines() << ",\t#nodes="
                 << d.triangulation.n_used_vertices() << ",\t#dofs="
-                << d.dof_handler.n_dofs();
+                << d.dof_handler.n_dofs() << "\n" << d.get_memory_report();
         return os;
     }
 
+    /**
+     * Memory used by the mesh, dofs, Jacobian, its UMFPACK factors and the caches,
+     * together with the peak resident memory of the process after every phase
+     */
+    MemoryReport get_memory_report() const;
+
     /** export the centroids of surface faces */
     void get_surface_nodes(std::vector<Point<dim>>& nodes);
 
-    /** read the electric field norm on the centroids of surface faces */
+    /** read the electric field norm on the centroids of surface faces; the values are copied */
     void set_electric_field_bc(const std::vector<double>& elfields);
 
+    /** read the electric field norm on the centroids of surface faces from an array in the order of
+     * get_surface_nodes, e.g. a SharedSurfaceChannel frame. Only the pointer is stored, so the array
+     * must stay valid until the next set_electric_field_bc, setup_mapping_field or setup_system */
+    void set_electric_field_bc(const double *elfields);
+
+    /** write the average temperature of the vertices of every surface face into an array
+     * in the order of get_surface_nodes */
+    void get_surface_temperatures(double *temperatures) const;
+
+    /**
+     * Export the values of the surface faces in the order of get_surface_nodes
+     * @param nodes centroids of the faces
+     * @param fields electric field norm used as the boundary condition of the faces (0 if not mapped)
+     * @param temperatures average temperature of the face vertices
+     */
+    void get_surface_values(std::vector<Point<dim>>& nodes, std::vector<double>& fields,
+            std::vector<double>& temperatures) const;
+
 private:
-    void assemble_system_newton();
-    void solve();
+    /**
+     * Assembles the linear system for one Newton iteration
+     * @param assemble_matrix if false, only the residual (rhs) is assembled
+     */
+    void assemble_system_newton(bool assemble_matrix = true);
+
+    /** Sets the unit diagonal and zero rhs in the constrained rows of the Newton system */
+    void apply_newton_dirichlet_bc(bool assemble_matrix);
+
+    /** Adds the local system to the global one, skipping the rows and columns of the Dirichlet dofs */
+    void distribute_local_to_global_newton(const FullMatrix<double> &cell_matrix,
+            const Vector<double> &cell_rhs,
+            const std::vector<types::global_dof_index> &local_dof_indices,
+            SparseMatrix<double> &matrix, Vector<double> &rhs, const bool assemble_matrix) const;
+
+    /**
+     * Electric field norm of a copper surface face from the array of set_electric_field_bc
+     * or from the interface mapping
+     * @return false if the face has no field
+     */
+    bool get_efield_bc(const std::pair<unsigned, unsigned> &face, double &efield) const;
+
+    /** Newton system assembly with the cell volume terms evaluated for batches of cells in SIMD lanes */
+    void assemble_system_newton_batched(bool assemble_matrix);
+
+    /** Preallocated face quadrature point data for assembling the Newton surface terms */
+    struct NewtonFaceScratch {
+        NewtonFaceScratch(const unsigned int n_face_q_points, const unsigned int dofs_per_cell) :
+                potential_gradients(n_face_q_points), temperature_values(n_face_q_points),
+                temperature_gradients(n_face_q_points), potential_phi(dofs_per_cell),
+                temperature_phi(dofs_per_cell) {
+        }
+        std::vector<Tensor<1, dim>> potential_gradients;
+        std::vector<double> temperature_values;
+        std::vector<Tensor<1, dim>> temperature_gradients;
+        std::vector<double> potential_phi;
+        std::vector<double> temperature_phi;
+    };
+
+    /** Persistent workspace of the Newton assemblers, created in setup_system */
+    struct NewtonScratch {
+        NewtonScratch(const FESystem<dim> &fe, const unsigned int quadrature_points_1d,
+                const unsigned int face_quadrature_points_1d);
+
+        QGauss<dim> quadrature;
+        QGauss<dim - 1> face_quadrature;
+        FEValues<dim> fe_values;
+        FEFaceValues<dim> fe_face_values;
+
+        FullMatrix<double> cell_matrix;
+        Vector<double> cell_rhs;
+        std::vector<types::global_dof_index> local_dof_indices;
+
+        // The previous solution values in the cell quadrature points
+        std::vector<Tensor<1, dim>> potential_gradients;
+        std::vector<double> temperature_values;
+        std::vector<Tensor<1, dim>> temperature_gradients;
+
+        // Shape function values and gradients (arrays for every cell DOF)
+        std::vector<Tensor<1, dim>> potential_phi_grad;
+        std::vector<double> temperature_phi;
+        std::vector<Tensor<1, dim>> temperature_phi_grad;
+
+        NewtonFaceScratch face;
+
+        // Partial reassembly
+        Vector<double> cell_solution;
+        FullMatrix<double> cell_matrix_difference;
+        Vector<double> cell_rhs_difference;
+
+        // Batched assembly, every lane holds the values of one cell
+        AlignedVector<VectorizedArray<double> > jxw, sigma, dsigma, kappa, dkappa;
+        AlignedVector<Tensor<1, dim, VectorizedArray<double> > > prev_pot_grad, prev_temp_grad;
+        AlignedVector<VectorizedArray<double> > batch_temperature_phi;
+        AlignedVector<Tensor<1, dim, VectorizedArray<double> > > batch_potential_phi_grad;
+        AlignedVector<Tensor<1, dim, VectorizedArray<double> > > batch_temperature_phi_grad;
+        AlignedVector<VectorizedArray<double> > batch_matrix, batch_rhs;
+        AlignedVector<VectorizedArray<double> > pot_grad_dot_phi, temp_grad_dot_phi;
+        std::vector<typename DoFHandler<dim>::active_cell_iterator> batch_cells;
+    };
+
+    /** Adds the emission current and Nottingham terms of the cell copper surface faces to the local system */
+    void assemble_surface_terms_newton(const typename DoFHandler<dim>::active_cell_iterator &cell,
+            FEFaceValues<dim> &fe_face_values, NewtonFaceScratch &scratch,
+            FullMatrix<double> &cell_matrix, Vector<double> &cell_rhs, const bool assemble_matrix);
+
+    /**
+     * Solves for the Newton update
+     * @param refactorize if false, the previously factorized Jacobian is reused
+     */
+    void solve(bool refactorize = true);
+
+    /** Marks all the cached local systems as outdated */
+    void invalidate_cell_cache();
+
+    /** Checks if the cell solution values differ from the cached ones more than the reassembly tolerances */
+    bool cell_cache_outdated(const Vector<double> &cached_solution,
+            const Vector<double> &cell_solution) const;
 
     bool setup_mapping();
     /**
@@ -202,6 +412,9 @@ private:
     Triangulation<dim> triangulation;
     DoFHandler<dim> dof_handler;
 
+    /** Zero Newton update for both components at the copper bottom */
+    ConstraintMatrix newton_constraints;
+    std::vector<types::global_dof_index> dirichlet_dofs;  ///< the dofs constrained by newton_constraints
     SparsityPattern sparsity_pattern;
     SparseMatrix<double> system_matrix;
 
@@ -209,9 +422,42 @@ private:
     Vector<double> newton_update;
     Vector<double> system_rhs;
 
+    std::unique_ptr<NewtonScratch> newton_scratch;
+
+    SparseDirectUMFPACK A_direct;     ///< factorization of the last assembled Jacobian
+    bool jacobian_factorized;         ///< A_direct holds a factorization of the current system
+    std::size_t factor_memory;        ///< growth of the resident memory in the last factorization
+
+    bool jacobian_reuse;              ///< use chord (modified Newton) iterations
+    double max_contraction_rate;      ///< contraction rate after which a fresh Jacobian is taken
+
+    /** Local Newton system of a cell and the local solution values it was built from */
+    struct CellCache {
+        FullMatrix<double> matrix;
+        Vector<double> rhs;
+        Vector<double> solution;
+        bool valid = false;
+    };
+    std::vector<CellCache> cell_cache;
+
+    bool batched_assembly;                    ///< assemble the Newton system in SIMD cell batches
+    int n_newton_iterations;                  ///< Newton iterations done in the last run_specific
+
+    bool warm_start;                          ///< start from the solution of the previous run
+    bool warm_solution_valid;                 ///< present_solution is a converged solution on the present mesh
+
+    double reassembly_temperature_tolerance;  ///< negative value disables partial reassembly
+    double reassembly_potential_tolerance;    ///< relative tolerance of the potential change
+
+    SparseMatrix<double> assembled_matrix;    ///< Jacobian without Dirichlet BCs, updated by differences
+    Vector<double> assembled_rhs;             ///< residual without Dirichlet BCs, updated by differences
+
     PhysicalQuantities *pq;
     Laplace<dim> *laplace;
 
+    mutable MemoryReport memory_report;       ///< peak resident memory after the phases
+    TraceRecorder *tracer;                    ///< timeline of the phases, NULL if disabled
+
     /** Mapping of copper interface face to vacuum side
      * (copper_cell_index, copper_cell_face) <-> (vacuum_cell_index, vacuum_cell_face)
      */
@@ -221,9 +467,21 @@ private:
      */
     std::map<std::pair<unsigned, unsigned>, double> interface_map_field;
 
+    /** Position of the copper surface faces in the arrays of set_electric_field_bc, built in setup_system
+     * (copper_cell_index, copper_cell_face) <-> (index in the array)
+     */
+    std::map<std::pair<unsigned, unsigned>, unsigned> surface_face_index;
+    std::vector<double> efield_values;        ///< copy of the vector given to set_electric_field_bc
+    const double *efield_array;               ///< field norm of the surface faces; NULL to use interface_map_field
+
     /** Previous iteration mesh and solution for setting the initial condition */
     CurrentsAndHeatingStationary* previous_iteration;
     bool interp_initial_conditions;
+
+    NewtonProgress progress_callback;         ///< called after every Newton iteration, may be empty
+    const CancellationToken *cancellation;    ///< stops the Newton iterations, NULL if disabled
+
+    SolverWorker worker;                      ///< runs the async solves; last member, so it is joined first
 };
 
 } // end fch namespace
@@ -0,0 +1,110 @@
+/*
+ * element_kernels.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_ELEMENT_KERNELS_H_
+#define INCLUDE_ELEMENT_KERNELS_H_
+
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/full_matrix.h>
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <array>
+#include <vector>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Compile-time sizes of the scalar Lagrange (FE_Q) elements integrated with QGauss(degree+1).
+ * Only the combinations (dim, degree) in {2,3}x{1,2} are provided.
+ */
+template<int dim, int degree>
+struct ElementTraits {
+    static_assert((dim == 2 || dim == 3) && (degree == 1 || degree == 2),
+            "Element kernels are implemented only for dim = 2, 3 and degree = 1, 2");
+
+    static constexpr unsigned int n_1d = degree + 1;   ///< dofs and Gauss points per direction
+    static constexpr unsigned int dofs_per_cell = dim == 2 ? n_1d * n_1d : n_1d * n_1d * n_1d;
+    static constexpr unsigned int n_q_points = dofs_per_cell;
+};
+
+/** @brief Local matrix and vector kernels with the element size known at compile time.
+ * The shape function data is copied from a reinitialized FEValues object into fixed size arrays,
+ * so that the loops over dofs and quadrature points can be fully unrolled and vectorized
+ * and no heap allocation is done per cell.
+ */
+template<int dim, int degree>
+class ElementKernel {
+public:
+    static constexpr unsigned int dofs_per_cell = ElementTraits<dim, degree>::dofs_per_cell;
+    static constexpr unsigned int n_q_points = ElementTraits<dim, degree>::n_q_points;
+
+    typedef std::array<double, dofs_per_cell * dofs_per_cell> LocalMatrix; ///< row-major local matrix
+    typedef std::array<double, dofs_per_cell> LocalVector;
+    typedef std::array<double, n_q_points> QuadratureValues;
+
+    /**
+     * Copy the shape function values, gradients and JxW values of the current cell
+     * @param fe_values FEValues reinitialized on the cell with update_JxW_values and the requested flags
+     * @param values copy the shape function values (needs update_values)
+     * @param gradients copy the shape function gradients (needs update_gradients)
+     */
+    void reinit(const FEValues<dim> &fe_values, const bool values, const bool gradients);
+
+    /** matrix(i,j) += sum_q coefficient[q] * grad phi_i * grad phi_j * JxW */
+    void add_stiffness(const QuadratureValues &coefficient, LocalMatrix &matrix) const;
+
+    /** matrix(i,j) += sum_q (mass_coefficient[q] * phi_i * phi_j
+     *                        + stiffness_coefficient[q] * grad phi_i * grad phi_j) * JxW */
+    void add_mass_stiffness(const QuadratureValues &mass_coefficient,
+            const QuadratureValues &stiffness_coefficient, LocalMatrix &matrix) const;
+
+    /** rhs(i) += sum_q coefficient[q] * phi_i * JxW */
+    void add_value_rhs(const QuadratureValues &coefficient, LocalVector &rhs) const;
+
+    /** rhs(i) += sum_q grad phi_i * vector[q] * JxW */
+    void add_gradient_rhs(const std::array<Tensor<1, dim>, n_q_points> &vector, LocalVector &rhs) const;
+
+    /** shape function value phi_i(x_q) */
+    double shape_value(const unsigned int i, const unsigned int q) const {
+        return phi[q * dofs_per_cell + i];
+    }
+
+    /** d-th component of the shape function gradient grad phi_i(x_q) */
+    double shape_grad(const unsigned int i, const unsigned int q, const unsigned int d) const {
+        return grad_phi[(q * dim + d) * dofs_per_cell + i];
+    }
+
+    double JxW(const unsigned int q) const {
+        return jxw[q];
+    }
+
+    /** Add the local matrix and vector to the global system through the constraints.
+     * The constrained rows and columns are eliminated symmetrically and the inhomogeneities
+     * are moved to the right-hand side, so no boundary pass is needed after the assembly.
+     */
+    void distribute_local_to_global(const LocalMatrix &matrix, const LocalVector &rhs,
+            const std::vector<types::global_dof_index> &local_dof_indices,
+            const ConstraintMatrix &constraints, SparseMatrix<double> &system_matrix,
+            Vector<double> &system_rhs);
+
+private:
+    /** Shape values in [q][i] layout, so that the innermost loop over dofs is contiguous */
+    std::array<double, n_q_points * dofs_per_cell> phi;
+    /** Shape gradients in [q][d][i] layout */
+    std::array<double, n_q_points * dim * dofs_per_cell> grad_phi;
+    std::array<double, n_q_points> jxw;
+
+    /** ConstraintMatrix works on FullMatrix and Vector, the local system is copied here */
+    FullMatrix<double> constrained_matrix;
+    Vector<double> constrained_rhs;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_ELEMENT_KERNELS_H_ */
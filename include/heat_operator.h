@@ -0,0 +1,120 @@
+/*
+ * heat_operator.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_HEAT_OPERATOR_H_
+#define INCLUDE_HEAT_OPERATOR_H_
+
+#include <deal.II/base/subscriptor.h>
+#include <deal.II/base/table.h>
+#include <deal.II/base/vectorization.h>
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/matrix_free/matrix_free.h>
+#include <deal.II/matrix_free/fe_evaluation.h>
+
+#include <utility>
+
+#include "physical_quantities.h"
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Matrix-free operator of the Crank-Nicolson heat equation system matrix
+ *  A = mass_coefficient * M + K(kappa(T)).
+ * The heat conductivity is evaluated from the given temperature in the quadrature points
+ * once per time step; the operator itself is applied cell by cell without building a global matrix.
+ * The constrained (Dirichlet) dofs are treated as homogeneous and get identity rows,
+ * the inhomogeneous values are handled by lifting the right-hand side (see apply_lifting).
+ * The interface (vmult, Tvmult, m, n, el) is the one expected by SolverCG and PreconditionChebyshev.
+ */
+template<int dim, int fe_degree>
+class HeatOperator: public Subscriptor {
+public:
+    HeatOperator();
+
+    /** Initialize the matrix-free data
+     * @param dof_handler dof handler of the scalar FE_Q<dim>(fe_degree) temperature space
+     * @param constraints Dirichlet constraints of the temperature; the inhomogeneities are ignored
+     */
+    void reinit(const DoFHandler<dim> &dof_handler, const ConstraintMatrix &constraints);
+
+    /** Remove the matrix-free data and coefficients */
+    void clear();
+
+    /** Evaluate the coefficients of the operator
+     * @param mass_coefficient  coefficient of the mass matrix (2*rho*cp/dt for Crank-Nicolson)
+     * @param temperature       temperature [K] used to evaluate kappa in the quadrature points
+     * @param pq                physical quantities to evaluate kappa
+     */
+    void set_coefficients(const double mass_coefficient, const Vector<double> &temperature,
+            const PhysicalQuantities &pq);
+
+    /** dst = A * src; the constrained rows are identity rows */
+    void vmult(Vector<double> &dst, const Vector<double> &src) const;
+
+    /** A is symmetric, so Tvmult equals vmult */
+    void Tvmult(Vector<double> &dst, const Vector<double> &src) const;
+
+    /** dst = A * lift restricted to the unconstrained rows, where lift may have nonzero constrained entries;
+     * subtracting it from the right-hand side moves the inhomogeneous Dirichlet values to the rhs */
+    void apply_lifting(Vector<double> &dst, const Vector<double> &lift) const;
+
+    /** Inverse of the diagonal of A for the Jacobi/Chebyshev smoother; updated in set_coefficients */
+    const Vector<double>& get_inverse_diagonal() const {
+        return inverse_diagonal;
+    }
+
+    unsigned int m() const {
+        return n_dofs;
+    }
+
+    unsigned int n() const {
+        return n_dofs;
+    }
+
+    /** Only the diagonal entries can be queried; they are needed by PreconditionChebyshev */
+    double el(const unsigned int row, const unsigned int col) const;
+
+    /** true when reinit() has been called with a dof handler */
+    bool initialized() const {
+        return n_dofs > 0;
+    }
+
+    /** Memory used by the matrix-free data and the coefficients in bytes */
+    std::size_t memory_consumption() const;
+
+private:
+    typedef FEEvaluation<dim, fe_degree, fe_degree + 1, 1, double> FEEval;
+
+    /** Cell loop worker applying A to the homogeneous part of src */
+    void local_apply(const MatrixFree<dim, double> &data, Vector<double> &dst,
+            const Vector<double> &src, const std::pair<unsigned int, unsigned int> &cell_range) const;
+
+    /** Cell loop worker applying A to src including its constrained entries */
+    void local_apply_plain(const MatrixFree<dim, double> &data, Vector<double> &dst,
+            const Vector<double> &src, const std::pair<unsigned int, unsigned int> &cell_range) const;
+
+    /** Quadrature point operation shared by the workers */
+    void do_quadrature(FEEval &phi, const unsigned int cell) const;
+
+    /** Compute the inverse of the diagonal of A with the current coefficients */
+    void compute_inverse_diagonal();
+
+    MatrixFree<dim, double> data;
+
+    /** kappa(T) in every quadrature point of every cell batch */
+    Table<2, VectorizedArray<double> > kappa;
+    double mass_coefficient;
+
+    Vector<double> inverse_diagonal;
+    unsigned int n_dofs;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_HEAT_OPERATOR_H_ */
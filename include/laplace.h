@@ -8,18 +8,40 @@
 #ifndef INCLUDE_LAPLACE_H_
 #define INCLUDE_LAPLACE_H_
 
+#include <deal.II/base/function.h>
 #include <deal.II/grid/tria.h>
 #include <deal.II/grid/grid_reordering.h>
 #include <deal.II/dofs/dof_handler.h>
 #include <deal.II/fe/fe_q.h>
+#include <deal.II/fe/fe_values.h>
+#include <deal.II/base/quadrature_lib.h>
 #include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/precondition.h>
+#include <deal.II/lac/solver_control.h>
+#include <deal.II/lac/solver_cg.h>
 
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
 
 #include "currents_and_heating.h" // for friend class declaration
 #include "currents_and_heating_stationary.h" // for friend class declaration
 #include "mesh_preparer.h"
+#include "element_kernels.h"
+#include "mixed_precision.h"
+#include "multi_vector_cg.h"
+#include "anderson_mixer.h"
+#include "memory_report.h"
+#include "trace_recorder.h"
+#include "solver_stats.h"
+#include "ssor_tuner.h"
+#include "solver_worker.h"
 
 namespace fch {
 
@@ -36,10 +58,24 @@ using namespace dealii;
 template<int dim>
 class Laplace {
 public:
+    /**
+     * Function that evaluates the space charge for the present potential (get_potential, get_efield etc).
+     * It must fill the vector (sized to the number of dofs) with the nodal values of
+     * the charge density divided by the vacuum permittivity, rho/eps0, in V/nm^2.
+     */
+    typedef std::function<void(const Laplace<dim> &laplace, Vector<double> &charge_density)> SpaceChargeFunction;
+
     Laplace();
 
-    /** Runs the calculation: setup and assemble system, solve Laplace equation, output the results*/
-    void run();
+    /** Runs the calculation: setup and assemble system, solve Laplace equation, output the results
+     * @return statistics of the solve and wall times of the phases */
+    LaplaceRunStats run();
+
+    /**
+     * Starts run() on the worker thread of the solver.
+     * The solver must not be used until the future is ready.
+     */
+    std::future<LaplaceRunStats> run_async();
 
     /** getter for the mesh */
     Triangulation<dim>* get_triangulation();
@@ -49,6 +85,14 @@ public:
     /** Sets the applied electric field in GV/m (V/nm) boundary condition */
     void set_applied_efield(const double applied_field_);
 
+    /**
+     * Changes the applied field of an assembled system without reassembling it.
+     * The rhs and the solution are linear in the field, so both are scaled and the next solve
+     * starts from the exact solution. Not valid after solve_space_charge.
+     * @return false if the system was assembled with zero field and must be reassembled
+     */
+    bool rescale_applied_efield(const double applied_field_);
+
     /**
      * Imports mesh from file and sets the vacuum boundary indicators
      * @param file_name name of the mesh file
@@ -67,6 +111,9 @@ public:
     /** get the electric field at the specified point */
     double probe_efield(const Point<dim> &p) const;
 
+    /** Maximum electric field norm in the face quadrature points of the copper surface */
+    double get_max_surface_field() const;
+
     /**
      * method to obtain the electric potential values in selected nodes
      * @param cell_indexes global cell indexes, where the corresponding nodes are situated
@@ -85,6 +132,33 @@ public:
     std::vector<Tensor<1, dim>> get_efield(const std::vector<int> &cell_indexes,
             const std::vector<int> &vert_indexes);
 
+    /**
+     * Enables or disables reusing the local stiffness matrices of congruent cells in assemble_system.
+     * Cells that are translated copies of each other (structured parts of the mesh) share one
+     * precomputed local matrix. Disabled by default.
+     */
+    void set_congruent_cell_cache(const bool enable);
+
+    /**
+     * Selects the mixed precision mode of the SSOR preconditioned CG in solve().
+     * MixedPrecisionCG::off (default) keeps the whole solve in double precision.
+     */
+    void set_mixed_precision(const MixedPrecisionCG::Mode mode);
+
+    /**
+     * Enables tuning the SSOR relaxation parameter during the solves.
+     * The first solves search for the parameter with the least CG iterations and the best one
+     * is used afterwards; the search is repeated if the iterations grow. While enabled,
+     * the ssor_param argument of solve() is ignored; the used value is in SolveStats::ssor_param.
+     */
+    void set_ssor_autotuning(const bool enable);
+
+    /**
+     * Records the setup, assembly, solve and output phases and the CG iterations into the recorder.
+     * NULL (default) disables the tracing.
+     */
+    void set_trace_recorder(TraceRecorder *recorder);
+
     /** @brief set up dynamic sparsity pattern
      *  a) define optimal structure for sparse matrix representation,
      *  b) allocate memory for sparse matrix and solution and right-hand-side (rhs) vector
@@ -103,10 +177,65 @@ public:
      * @param pc_ssor flag to use SSOR preconditioner
      * @param ssor_param   parameter to SSOR preconditioner. 1.2 is known to work well with laplace.
      *                     its fine tuning optimises calculation time
+     * @return CG iterations, residual history and wall time of the solve
      */
-    void solve(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
+    SolveStats solve(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
+            double ssor_param = 1.2);
+
+    /** Starts solve() on the worker thread of the solver; the solver must not be used until the future is ready */
+    std::future<SolveStats> solve_async(int max_iter = 2000, double tol = 1e-9, bool pc_ssor = true,
             double ssor_param = 1.2);
 
+    /** Number of CG iterations done in the last solve */
+    unsigned int get_n_iterations() const {
+        return n_iterations;
+    }
+
+    /**
+     * Assembles the right-hand-side vector for a position dependent Neumann boundary condition
+     * on top of the vacuum domain. The system matrix does not depend on the boundary load,
+     * so the vectors can be solved together with solve_multiple.
+     * @param top_field_profile  applied electric field in GV/m (V/nm) on the vacuum_top faces
+     * @param rhs                assembled right-hand-side vector
+     */
+    void assemble_rhs(const Function<dim> &top_field_profile, Vector<double> &rhs) const;
+
+    /** solves the matrix equation for several right-hand sides at once.
+     * The systems are iterated together so that every CG iteration reads the system matrix
+     * only once for all the right-hand sides.
+     * @param rhs        right-hand-side vectors assembled with assemble_rhs
+     * @param solutions  resulting potentials; sizes are adjusted and the old values are used as initial guesses
+     * @param max_iter   maximum number of iterations allowed
+     * @param tol        tolerance of every solution
+     * @param pc_ssor    flag to use SSOR preconditioner
+     * @param ssor_param parameter to SSOR preconditioner
+     * @return number of iterations needed for the slowest right-hand side and the wall time
+     */
+    SolveStats solve_multiple(const std::vector<Vector<double> > &rhs,
+            std::vector<Vector<double> > &solutions, int max_iter = 2000, double tol = 1e-9,
+            bool pc_ssor = true, double ssor_param = 1.2);
+
+    /**
+     * Solves the Poisson equation self-consistently with the space charge.
+     * The system matrix, its SSOR preconditioner and the mass matrix are set up once;
+     * every outer iteration only updates the right-hand side from the space charge,
+     * warm-starts CG from the previous potential and Anderson-accelerates the outer iteration.
+     * setup_system and assemble_system must be called before.
+     * @param space_charge     function returning the charge density for the present potential
+     * @param max_outer_iter   maximum number of space charge iterations
+     * @param outer_tol        tolerance of the relative change of the potential between the iterations
+     * @param anderson_depth   number of previous iterates used in Anderson acceleration, 0 disables it
+     * @param mixing           damping of the potential update, 1.0 means no damping
+     * @param max_iter         maximum number of CG iterations in every Poisson solve
+     * @param tol              tolerance of every Poisson solve
+     * @param ssor_param       parameter to SSOR preconditioner
+     * @return number of space charge iterations done, whether they converged and the
+     *         relative potential change of every iteration as the residual history
+     */
+    SolveStats solve_space_charge(const SpaceChargeFunction &space_charge, unsigned int max_outer_iter = 50,
+            double outer_tol = 1e-6, unsigned int anderson_depth = 5, double mixing = 1.0,
+            int max_iter = 2000, double tol = 1e-9, double ssor_param = 1.2);
+
     /** Outputs the results (electric potential and field) to a specified file in vtk format */
     void output_results(const std::string filename = "field_solution.vtk") const;
 
@@ -116,17 +245,30 @@ public:
         output_results(filename);
     };
 
-    /** Print the statistics about the mesh and # degrees of freedom */
+    /**
+     * Memory used by the mesh, dofs, matrices, vectors and solver data,
+     * together with the peak resident memory of the process after every phase
+     */
+    MemoryReport get_memory_report() const;
+
+    /** Print the statistics about the mesh, # degrees of freedom and memory usage */
     friend std::ostream& operator <<(std::ostream &os, const Laplace<dim>& d) {
         os << "#elems=" << d.triangulation.n_active_cells() << ",\t#faces="
                 << d.triangulation.n_active_faces() << ",\t#edges="
                 << d.triangulation.n_active_lines() << ",\t#nodes="
                 << d.triangulation.n_used_vertices() << ",\t#dofs="
-                << d.dof_handler.n_dofs();
+                << d.dof_handler.n_dofs() << "\n" << d.get_memory_report();
         return os;
     }
 
 private:
+    /**
+     * Translation invariant signature of the cell shape:
+     * vertex coordinates relative to the first vertex, rounded to the multiples of signature_quantum
+     */
+    typedef std::array<std::int64_t, dim * (GeometryInfo<dim>::vertices_per_cell - 1)> CellSignature;
+    CellSignature cell_signature(const typename DoFHandler<dim>::active_cell_iterator &cell) const;
+
     static constexpr unsigned int shape_degree = 1;   ///< degree of the shape functions (linear, quadratic etc elements)
     static constexpr unsigned int quadrature_degree = shape_degree + 1;  ///< degree of the Gaussian numerical integration
 
@@ -137,12 +279,67 @@ private:
     FE_Q<dim> fe;
     DoFHandler<dim> dof_handler;
 
+    ConstraintMatrix constraints;         ///< zero potential on the copper surface
     SparsityPattern sparsity_pattern;     ///< structure for sparse matrix representation
     SparseMatrix<double> system_matrix;   ///< system matrix of matrix equation
 
     Vector<double> solution;              ///< resulting electric potential in the mesh nodes
     Vector<double> system_rhs;            ///< right-hand-side of the matrix equation
 
+    // Linear solver and preconditioner kept between the solves
+    HistorySolverControl solver_control;
+    SolverCG<> solver_cg;
+    PreconditionSSOR<> preconditioner_ssor;
+
+    unsigned int n_iterations;            ///< CG iterations of the last solve
+
+    bool ssor_autotuning;                 ///< choose the SSOR parameter with ssor_tuner
+    SSORTuner ssor_tuner;
+
+    MixedPrecisionCG::Mode mixed_precision;
+    MixedPrecisionCG mixed_precision_cg;
+
+    MultiVectorCG multi_vector_cg;        ///< CG for several right-hand sides
+
+    // Space charge iteration
+    SparsityPattern mass_sparsity_pattern;  ///< sparsity without the constraints, as the charge on the copper surface contributes too
+    SparseMatrix<double> mass_matrix;       ///< maps the nodal charge density to the right-hand side
+    Vector<double> boundary_rhs;            ///< right-hand side without the space charge
+    Vector<double> charge_density;
+    Vector<double> space_charge_rhs;
+    Vector<double> space_charge_update;     ///< potential from the latest Poisson solve
+    AndersonMixer anderson_mixer;
+
+    mutable MemoryReport memory_report;     ///< peak resident memory after the phases
+    TraceRecorder *tracer;                  ///< timeline of the phases, NULL if disabled
+
+    typedef typename ElementKernel<dim, shape_degree>::LocalMatrix LocalMatrix;
+
+    /** Persistent workspace of assemble_system, created in setup_system */
+    struct AssemblyScratch {
+        AssemblyScratch(const FE_Q<dim> &fe) :
+                quadrature(quadrature_degree), face_quadrature(quadrature_degree),
+                fe_values(fe, quadrature, update_gradients | update_quadrature_points | update_JxW_values),
+                fe_face_values(fe, face_quadrature,
+                        update_values | update_quadrature_points | update_JxW_values),
+                local_dof_indices(fe.dofs_per_cell) {
+        }
+        QGauss<dim> quadrature;
+        QGauss<dim - 1> face_quadrature;
+        FEValues<dim> fe_values;
+        FEFaceValues<dim> fe_face_values;
+        ElementKernel<dim, shape_degree> kernel;
+        std::vector<types::global_dof_index> local_dof_indices;
+    };
+    std::unique_ptr<AssemblyScratch> assembly_scratch;
+
+    bool use_congruent_cell_cache;        ///< reuse the local matrices of translated cells
+    double signature_quantum;             ///< rounding length of the cell signatures, set in setup_system
+    /** Local stiffness matrices of the assembled cells mapped by their shape signature */
+    std::map<CellSignature, LocalMatrix> congruent_cell_matrices;
+
+    SolverWorker worker;                  ///< runs the async solves; last member, so it is joined first
+
     friend class CurrentsAndHeating<dim> ;
     friend class CurrentsAndHeatingStationary<dim> ;
 };
@@ -0,0 +1,51 @@
+/*
+ * memory_report.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MEMORY_REPORT_H_
+#define INCLUDE_MEMORY_REPORT_H_
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fch {
+
+/** @brief Memory footprint of the data structures of a solver
+ * together with the peak resident memory of the process at the end of its phases.
+ */
+class MemoryReport {
+public:
+    /** Sets the size of a data structure in bytes; replaces the previous value with the same name */
+    void set_item(const std::string &name, const std::size_t bytes);
+
+    /** Stores the current peak resident memory of the process as the value of the phase */
+    void record_phase(const std::string &phase);
+
+    /** Forgets the recorded phases */
+    void clear_phases();
+
+    /** Sum of the data structure sizes in bytes */
+    std::size_t total() const;
+
+    /** Peak resident memory (VmHWM) of the process in bytes */
+    static std::size_t peak_rss();
+
+    /** Current resident memory (VmRSS) of the process in bytes */
+    static std::size_t current_rss();
+
+    /** Prints the data structures and phases in MB */
+    friend std::ostream& operator <<(std::ostream &os, const MemoryReport &report);
+
+private:
+    std::vector<std::pair<std::string, std::size_t> > items;    ///< data structure name and bytes
+    std::vector<std::pair<std::string, std::size_t> > phases;   ///< phase name and peak RSS in bytes
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_MEMORY_REPORT_H_ */
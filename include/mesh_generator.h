@@ -0,0 +1,113 @@
+/*
+ * mesh_generator.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MESH_GENERATOR_H_
+#define INCLUDE_MESH_GENERATOR_H_
+
+#include <deal.II/grid/tria.h>
+
+#include <vector>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Generates matching structured vacuum and copper meshes of a nanotip for scaling studies.
+ *
+ * The copper surface is the height field h(r) = H * exp(-r^2 / (2*R*H)) of the lateral
+ * distance r from the tip axis; it has height H and apex curvature radius R.
+ * Both meshes are extruded from the same lateral grid: vacuum from the surface up to the top of
+ * the box and copper from the bottom of the box up to the surface, so the interface vertices are
+ * identical and the meshes conform exactly. The boundaries are marked with MeshPreparer.
+ */
+template<int dim>
+class MeshGenerator {
+public:
+    MeshGenerator();
+
+    /**
+     * Sets the tip shape
+     * @param height  height of the tip apex above the flat surface
+     * @param radius  curvature radius of the apex
+     */
+    void set_tip(const double height, const double radius);
+
+    /**
+     * Sets the simulation box; the flat surface is at z = 0 and the box is centered at the tip axis
+     * @param width          lateral size of the box
+     * @param vacuum_height  position of the vacuum top; must be above the tip apex
+     * @param copper_depth   depth of the copper bottom below the flat surface
+     */
+    void set_box(const double width, const double vacuum_height, const double copper_depth);
+
+    /**
+     * Sets the number of cells
+     * @param n_lateral        cells along every lateral direction
+     * @param n_vacuum_layers  cell layers between the surface and the vacuum top
+     * @param n_copper_layers  cell layers between the copper bottom and the surface
+     */
+    void set_resolution(const unsigned int n_lateral, const unsigned int n_vacuum_layers,
+            const unsigned int n_copper_layers);
+
+    /**
+     * Chooses the resolution so that the two meshes together have about n_cells cells;
+     * the vertical layers are split evenly between vacuum and copper
+     */
+    void set_target_cells(const unsigned long n_cells);
+
+    /**
+     * Sets the mesh grading; 1.0 gives uniform spacing
+     * @param lateral   exponent > 1 concentrates the lateral grid lines near the tip axis
+     * @param vertical  exponent > 1 concentrates the cell layers near the surface
+     */
+    void set_grading(const double lateral, const double vertical);
+
+    /** Number of cells in the vacuum mesh */
+    unsigned long n_vacuum_cells() const;
+
+    /** Number of cells in the copper mesh */
+    unsigned long n_copper_cells() const;
+
+    /** Height of the copper surface at the given lateral distance from the tip axis */
+    double surface_height(const double r) const;
+
+    /**
+     * Replaces the mesh with the vacuum mesh and marks its boundaries
+     * @param triangulation  pointer to the vacuum mesh, e.g. Laplace::get_triangulation()
+     */
+    void generate_vacuum_mesh(Triangulation<dim> *triangulation) const;
+
+    /**
+     * Replaces the mesh with the copper mesh and marks its boundaries
+     * @param triangulation  pointer to the copper mesh, e.g. CurrentsAndHeating::get_triangulation()
+     */
+    void generate_copper_mesh(Triangulation<dim> *triangulation) const;
+
+private:
+    /** Lateral coordinate of the grid line i = 0..n_lateral */
+    double lateral_coordinate(const unsigned int i) const;
+
+    /** Vertices and cells of the vacuum (true) or copper (false) mesh */
+    void make_mesh_data(const bool vacuum, std::vector<Point<dim> > &vertices,
+            std::vector<CellData<dim> > &cells) const;
+
+    double tip_height;
+    double tip_radius;
+    double box_width;
+    double vacuum_height;
+    double copper_depth;
+
+    unsigned int n_lateral;
+    unsigned int n_vacuum_layers;
+    unsigned int n_copper_layers;
+
+    double lateral_grading;
+    double vertical_grading;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_MESH_GENERATOR_H_ */
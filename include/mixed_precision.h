@@ -0,0 +1,87 @@
+/*
+ * mixed_precision.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MIXED_PRECISION_H_
+#define INCLUDE_MIXED_PRECISION_H_
+
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+#include <deal.II/lac/precondition.h>
+
+#include <vector>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Conjugate gradient solver for symmetric positive definite systems that does
+ * the bandwidth bound work on a single precision copy of the matrix.
+ *
+ * In float_preconditioner mode the CG iterations are done in double precision and only
+ * the SSOR sweeps read the float matrix. In float_inner_solver mode the whole preconditioned
+ * CG runs in single precision and an outer double precision defect correction loop
+ * (iterative refinement) drives the true residual ||b - Ax|| below the requested tolerance,
+ * so the final accuracy is the same as with the double precision solver.
+ */
+class MixedPrecisionCG {
+public:
+    enum Mode {
+        off,                    ///< use the double precision solver of the caller
+        float_preconditioner,   ///< double precision CG with single precision SSOR
+        float_inner_solver      ///< single precision SSOR-CG inside double precision defect correction
+    };
+
+    MixedPrecisionCG();
+
+    /** Relative residual reduction of every inner single precision solve (float_inner_solver mode) */
+    void set_inner_reduction(const double reduction);
+
+    /** Copy the matrix values into single precision and set up the preconditioner.
+     * Must be called after every assembly of the matrix.
+     * @param matrix      assembled double precision matrix
+     * @param ssor_param  relaxation parameter of the SSOR preconditioner
+     */
+    void initialize(const SparseMatrix<double> &matrix, const double ssor_param);
+
+    /** Solve matrix * solution = rhs; solution is used as the initial guess
+     * @param mode      float_preconditioner or float_inner_solver
+     * @param max_iter  maximum number of CG iterations (summed over the inner solves)
+     * @param tol       tolerance of the l2 norm of the double precision residual
+     * @return number of CG iterations done
+     */
+    unsigned int solve(const Mode mode, const SparseMatrix<double> &matrix, Vector<double> &solution,
+            const Vector<double> &rhs, const unsigned int max_iter, const double tol);
+
+    /** Memory used by the single precision matrix and work vectors in bytes */
+    std::size_t memory_consumption() const;
+
+    /** Number of defect correction steps in the last float_inner_solver solve */
+    unsigned int get_n_outer_steps() const {
+        return n_outer_steps;
+    }
+
+    /** Residual norms of the last solve: every CG iteration in float_preconditioner mode,
+     * every defect correction step in float_inner_solver mode */
+    const std::vector<double>& get_residual_history() const {
+        return residual_history;
+    }
+
+private:
+    SparseMatrix<float> matrix_float;                        ///< single precision copy of the matrix
+    PreconditionSSOR<SparseMatrix<float> > preconditioner;  ///< SSOR on the float matrix
+
+    Vector<double> residual;          ///< double precision residual and correction
+    Vector<float> residual_float;
+    Vector<float> correction_float;
+
+    double inner_reduction;
+    unsigned int n_outer_steps;
+    std::vector<double> residual_history;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_MIXED_PRECISION_H_ */
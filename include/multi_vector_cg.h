@@ -0,0 +1,79 @@
+/*
+ * multi_vector_cg.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MULTI_VECTOR_CG_H_
+#define INCLUDE_MULTI_VECTOR_CG_H_
+
+#include <deal.II/lac/sparse_matrix.h>
+#include <deal.II/lac/vector.h>
+
+#include <vector>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Preconditioned CG for several right-hand sides with the same symmetric positive definite matrix.
+ *
+ * The k systems are iterated in lock step and all the vectors are stored interleaved
+ * (entry i of vector j at i*k + j), so that every matrix-vector product and SSOR sweep
+ * reads the matrix once for all the k vectors. The recurrences of the systems are independent,
+ * so each one converges exactly like a separate CG solve; converged systems are frozen.
+ */
+class MultiVectorCG {
+public:
+    MultiVectorCG();
+
+    /**
+     * Solve matrix * solutions[j] = rhs[j] for all j; solutions are used as initial guesses
+     * @param matrix      square SPD matrix with the diagonal stored first in every row
+     * @param rhs         right-hand sides
+     * @param solutions   initial guesses on input, solutions on output
+     * @param max_iter    maximum number of iterations
+     * @param tol         tolerance of the l2 norm of every residual
+     * @param pc_ssor     flag to use SSOR preconditioner
+     * @param ssor_param  SSOR relaxation parameter
+     * @return number of iterations needed for the slowest system
+     */
+    unsigned int solve(const SparseMatrix<double> &matrix, const std::vector<Vector<double> > &rhs,
+            std::vector<Vector<double> > &solutions, const unsigned int max_iter, const double tol,
+            const bool pc_ssor = true, const double ssor_param = 1.2);
+
+    /** Iterations needed by every system in the last solve */
+    const std::vector<unsigned int>& get_iterations() const {
+        return iterations;
+    }
+
+    /** Memory used by the interleaved work vectors in bytes */
+    std::size_t memory_consumption() const;
+
+private:
+    /** dst = matrix * src for the k interleaved vectors */
+    void vmult(const SparseMatrix<double> &matrix, std::vector<double> &dst,
+            const std::vector<double> &src) const;
+
+    /** dst = P^-1 src with SSOR (as in SparseMatrix::precondition_SSOR) or identity */
+    void precondition(const SparseMatrix<double> &matrix, std::vector<double> &dst,
+            const std::vector<double> &src) const;
+
+    /** Per vector dot products of the interleaved a and b */
+    void dot(const std::vector<double> &a, const std::vector<double> &b,
+            std::vector<double> &result) const;
+
+    unsigned int n_vectors;
+    bool use_ssor;
+    double omega;
+
+    // interleaved work vectors
+    std::vector<double> x, r, z, p, q;
+    std::vector<double> rz, rz_new, pq, residual_norm2;
+    std::vector<bool> active;
+    std::vector<unsigned int> iterations;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_MULTI_VECTOR_CG_H_ */
@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <cstddef>
 
 namespace fch {
 
@@ -91,6 +92,9 @@ public:
      */
     double dkappa(double temperature);
 
+    /** Memory used by the tabulated data in bytes */
+    std::size_t memory_consumption() const;
+
     /**
      * Outputs sigma, kappa, res (and d-s) and emission currents to files in specified path
      * NB: Slow!!!
@@ -0,0 +1,168 @@
+/*
+ * shared_surface_channel.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SHARED_SURFACE_CHANNEL_H_
+#define INCLUDE_SHARED_SURFACE_CHANNEL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace fch {
+
+/** @brief POSIX shared memory exchange of the surface face data with a co-located process (e.g. MD).
+ *
+ * The arrays are laid out in the surface face order of get_surface_nodes(), so the solvers read the
+ * boundary conditions from and write the temperatures into the shared memory without copies
+ * (see the pointer versions of set_electric_field_bc, set_emission_bc and get_surface_temperatures).
+ *
+ * Each direction is double buffered: the writer fills the next frame while the reader still uses
+ * the previous one. Frames are numbered from 1; frame k lives in buffer k % 2. The writer may reuse
+ * a buffer only after the reader has released the frame that was in it, so a published frame is
+ * never overwritten while it is read. Synchronization uses two counters per direction
+ * (published and released frames) with acquire/release ordering; waiting spins and then sleeps.
+ * There must be a single writer and a single reader per direction.
+ *
+ * Typical coupling step on the solver side:
+ * @code
+ *   const double *in = channel.acquire(SharedSurfaceChannel::to_solver, step);
+ *   ch.set_electric_field_bc(channel.array(in, SharedSurfaceChannel::field));
+ *   ch.do_time_step();
+ *   channel.release(SharedSurfaceChannel::to_solver);
+ *   double *out = channel.begin_write(SharedSurfaceChannel::from_solver);
+ *   ch.get_surface_temperatures(channel.array(out, SharedSurfaceChannel::temperature));
+ *   channel.publish(SharedSurfaceChannel::from_solver);
+ * @endcode
+ */
+class SharedSurfaceChannel {
+public:
+    /** Direction of the data */
+    enum Direction {
+        to_solver = 0,      ///< field, emission current and Nottingham heat of the faces
+        from_solver = 1     ///< temperatures of the faces
+    };
+
+    /** Arrays of a to_solver frame */
+    enum InputArray {
+        field = 0,              ///< electric field norm [V/nm]
+        emission_current = 1,   ///< emission current density
+        nottingham_heat = 2     ///< Nottingham heat flux
+    };
+
+    /** Arrays of a from_solver frame */
+    enum OutputArray {
+        temperature = 0         ///< average temperature of the face vertices [K]
+    };
+
+    SharedSurfaceChannel();
+    ~SharedSurfaceChannel();
+
+    SharedSurfaceChannel(const SharedSurfaceChannel &) = delete;
+    SharedSurfaceChannel& operator=(const SharedSurfaceChannel &) = delete;
+
+    /**
+     * Creates the shared memory segment; it is removed when the channel is closed
+     * @param name POSIX shared memory name, e.g. "/fch_surface"
+     * @param dim dimension of the face centroids
+     * @param n_faces number of copper surface faces
+     * @return true if success, otherwise false
+     */
+    bool create(const std::string &name, const unsigned int dim, const unsigned int n_faces);
+
+    /**
+     * Maps a segment created by another process
+     * @return true if success, otherwise false
+     */
+    bool open(const std::string &name);
+
+    /** Unmaps the segment and removes it if it was created by this object */
+    void close();
+
+    bool is_open() const {
+        return header != NULL;
+    }
+
+    unsigned int get_dim() const;
+
+    unsigned int get_n_faces() const;
+
+    /** Face centroids (dim values per face), written once after the mesh is known */
+    double* get_centroids();
+
+    /**
+     * Waits until the buffer of the next frame is released by the reader
+     * @param timeout maximum wait [s]; negative waits forever
+     * @return the buffer to fill, NULL on timeout
+     */
+    double* begin_write(const Direction direction, const double timeout = -1.0);
+
+    /** Makes the frame filled after begin_write visible to the reader */
+    void publish(const Direction direction);
+
+    /**
+     * Waits until at least the given frame is published
+     * @param frame number of the frame, 1 for the first one
+     * @param timeout maximum wait [s]; negative waits forever
+     * @return the buffer of the newest published frame, NULL on timeout
+     */
+    const double* acquire(const Direction direction, const std::uint64_t frame, const double timeout = -1.0);
+
+    /** Allows the writer to reuse the buffer of the acquired frame */
+    void release(const Direction direction);
+
+    /** Number of published frames */
+    std::uint64_t get_published(const Direction direction) const;
+
+    /** Array of a frame buffer returned by begin_write or acquire */
+    double* array(double *buffer, const unsigned int index) const {
+        return buffer + std::size_t(index) * n_faces;
+    }
+    const double* array(const double *buffer, const unsigned int index) const {
+        return buffer + std::size_t(index) * n_faces;
+    }
+
+private:
+    /** Frame counters of one direction, on their own cache line */
+    struct alignas(64) Counters {
+        std::atomic<unsigned long long> published;
+        std::atomic<unsigned long long> released;
+    };
+
+    /** Start of the segment */
+    struct Header {
+        std::atomic<std::uint32_t> magic;   ///< stored last by the creator with release ordering
+        std::uint32_t version;
+        std::uint32_t dim;
+        std::uint32_t n_faces;
+        Counters counters[2];
+    };
+
+    /** Number of arrays in a frame of the direction */
+    static unsigned int n_arrays(const Direction direction);
+
+    /** Size of the segment in bytes */
+    static std::size_t segment_size(const unsigned int dim, const unsigned int n_faces);
+
+    /** Sets the array pointers after the segment is mapped */
+    void map_arrays();
+
+    /** Buffer of the frame */
+    double* buffer(const Direction direction, const unsigned long long frame);
+
+    std::string name;
+    bool owner;                 ///< created the segment and removes it
+    std::size_t size;
+    Header *header;
+    unsigned int n_faces;
+    double *centroids;
+    double *buffers[2];         ///< first buffer of each direction
+    unsigned long long acquired[2];  ///< frame held by the reader of each direction
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_SHARED_SURFACE_CHANNEL_H_ */
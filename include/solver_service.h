@@ -0,0 +1,132 @@
+/*
+ * solver_service.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SOLVER_SERVICE_H_
+#define INCLUDE_SOLVER_SERVICE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "laplace.h"
+#include "currents_and_heating_stationary.h"
+#include "physical_quantities.h"
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Long-running field, currents and heating solver for coupling with MD codes.
+ *
+ * The solvers, the loaded PhysicalQuantities and the solution of the previous request are kept
+ * between the requests, so a coupling step costs only the solves:
+ * - an unchanged vacuum mesh is not set up or reassembled again; a changed applied field only
+ *   rescales the assembled system and its solution;
+ * - an unchanged copper mesh continues the Newton iterations from the previous solution;
+ * - a changed copper mesh interpolates its initial condition from the previous mesh.
+ *
+ * Protocol: every message consists of a 16 byte header (uint32 magic, uint32 type, uint64 payload size)
+ * and the payload. All values are in the native byte order of the host, as the peer runs on the same
+ * machine. Every request gets a reply with the type of the request and a payload starting with an int32 status.
+ *
+ * Request payloads:
+ * - SET_VACUUM_MESH, SET_COPPER_MESH: uint32 n_vertices, uint32 n_cells,
+ *   double[n_vertices * dim] vertex coordinates, uint32[n_cells * vertices_per_cell] cell vertices;
+ *   reply: uint32 number of dofs
+ * - SET_PARAMETERS: double applied field [V/nm], double ambient temperature [K],
+ *   double temperature tolerance [K], int32 max Newton iterations, double sor_alpha,
+ *   double Laplace tolerance, int32 Laplace max CG iterations; empty reply
+ * - RUN: empty; reply: int32 Newton iterations, uint32 converged, double temperature error,
+ *   double peak temperature, uint32 Laplace CG iterations, double wall time [s], uint32 n_faces,
+ *   n_faces * (double[dim] face centroid, double field norm, double temperature)
+ * - SHUTDOWN: empty; empty reply, the service stops
+ */
+template<int dim>
+class SolverService {
+public:
+    static constexpr std::uint32_t magic = 0x53484346;  ///< "FCHS" in little endian
+
+    enum MessageType : std::uint32_t {
+        set_vacuum_mesh = 1,
+        set_copper_mesh = 2,
+        set_parameters = 3,
+        run = 4,
+        shutdown = 5
+    };
+
+    enum Status : std::int32_t {
+        ok = 0,
+        bad_request = 1,        ///< unknown type or malformed payload
+        mesh_failed = 2,        ///< the mesh could not be imported
+        not_ready = 3,          ///< run requested before both meshes were set
+        run_failed = 4          ///< interface mapping failed or the Newton iterations could not be started
+    };
+
+    /** Run parameters, changed with SET_PARAMETERS */
+    struct Parameters {
+        double applied_efield = 2.0;
+        double ambient_temperature = 300.0;
+        double temperature_tolerance = 1.0;
+        std::int32_t max_newton_iter = 10;
+        double sor_alpha = 1.0;
+        double laplace_tolerance = 1e-9;
+        std::int32_t laplace_max_iter = 2000;
+    };
+
+    /** @param pq_ physical quantities used by every request; must outlive the service */
+    SolverService(PhysicalQuantities *pq_);
+
+    /**
+     * Listens on a Unix domain socket and serves the clients one after another until a SHUTDOWN request
+     * @return false if the socket could not be created
+     */
+    bool serve(const std::string &socket_path);
+
+    /**
+     * Serves the requests read from in_fd (e.g. a pipe) and writes the replies to out_fd
+     * @return true if the connection was ended with SHUTDOWN, false on end of input or an i/o error
+     */
+    bool serve_connection(int in_fd, int out_fd);
+
+    /**
+     * Handles one request
+     * @param type message type of the request
+     * @param payload request payload
+     * @param reply reply payload after the status
+     * @return status of the request
+     */
+    Status handle_request(std::uint32_t type, const std::vector<char> &payload, std::vector<char> &reply);
+
+    /** Number of requests handled since the start */
+    unsigned int get_n_requests() const {
+        return n_requests;
+    }
+
+private:
+    Status import_mesh(bool vacuum, const std::vector<char> &payload, std::vector<char> &reply);
+    Status read_parameters(const std::vector<char> &payload);
+    Status run_solvers(std::vector<char> &reply);
+
+    PhysicalQuantities *pq;
+    Parameters parameters;
+
+    Laplace<dim> laplace;
+    bool vacuum_ready;          ///< vacuum mesh has been set up
+    bool vacuum_assembled;      ///< laplace holds an assembled system of the present mesh
+    double assembled_efield;    ///< applied field of the assembled system
+
+    /** The active solver and the one holding the previous mesh for the initial condition interpolation */
+    CurrentsAndHeatingStationary<dim> ch_solvers[2];
+    unsigned int active;
+    bool copper_ready;          ///< active solver has a mesh that has been set up
+    bool copper_solved;         ///< active solver holds a solution to interpolate from
+
+    unsigned int n_requests;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_SOLVER_SERVICE_H_ */
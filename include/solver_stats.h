@@ -0,0 +1,93 @@
+/*
+ * solver_stats.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SOLVER_STATS_H_
+#define INCLUDE_SOLVER_STATS_H_
+
+#include <deal.II/lac/solver_control.h>
+
+#include <vector>
+
+namespace fch {
+
+using namespace dealii;
+
+/** @brief Statistics of a linear (or fixed point) solve */
+struct SolveStats {
+    unsigned int iterations = 0;            ///< CG iterations; outer iterations in the space charge solve
+    double residual = 0.0;                  ///< residual norm of the last iteration
+    std::vector<double> residual_history;   ///< residual norm of every iteration, starting from the initial one
+    double wall_time = 0.0;                 ///< [s]
+    double ssor_param = 0.0;                ///< SSOR relaxation parameter used, 0 without SSOR
+    bool converged = true;                  ///< CG throws SolverControl::NoConvergence instead of returning false
+};
+
+/** @brief Statistics of a whole Laplace::run */
+struct LaplaceRunStats {
+    SolveStats solve;                       ///< CG solve
+
+    // wall times of the phases [s]
+    double setup_time = 0.0;
+    double assemble_time = 0.0;
+    double solve_time = 0.0;
+    double output_time = 0.0;
+    double wall_time = 0.0;                 ///< whole run
+};
+
+/** @brief Statistics of the Newton iterations of the stationary currents and heating */
+struct NewtonStats {
+    int iterations = 0;
+    bool converged = false;                 ///< temperature and potential changes fell below the tolerances
+    bool cancelled = false;                 ///< stopped by the cancellation token
+    double temperature_error = -1.0;        ///< max temperature change of the last iteration [K], -1 if the run failed
+    double potential_rel_error = 0.0;       ///< max relative potential change of the last iteration
+    double peak_temperature = 0.0;          ///< [K]
+    unsigned int n_factorizations = 0;      ///< number of fresh Jacobians (less than iterations with Jacobian reuse)
+
+    std::vector<double> temperature_error_history;  ///< temperature_error of every iteration
+    std::vector<double> residual_history;           ///< l2 norm of the Newton residual of every iteration
+
+    // wall times of the phases [s]
+    double mapping_time = 0.0;              ///< copper-vacuum interface mapping
+    double initial_condition_time = 0.0;
+    double assemble_time = 0.0;             ///< summed over the iterations
+    double solve_time = 0.0;                ///< factorization and back substitution summed over the iterations
+    double output_time = 0.0;
+    double wall_time = 0.0;                 ///< whole run
+};
+
+/** @brief Statistics of one time step of the transient currents and heating */
+struct StepStats {
+    SolveStats current;                     ///< current (potential) solve
+    SolveStats heat;                        ///< temperature solve
+    double assemble_current_time = 0.0;     ///< [s]
+    double assemble_heat_time = 0.0;        ///< [s]
+    double peak_temperature = 0.0;          ///< [K]
+    double wall_time = 0.0;                 ///< whole step [s]
+};
+
+/** @brief SolverControl that keeps the residual of every iteration of the last solve */
+class HistorySolverControl : public SolverControl {
+public:
+    HistorySolverControl(const unsigned int max_steps = 100, const double tolerance = 1e-10);
+
+    virtual State check(const unsigned int step, const double check_value);
+
+    /** Residuals of the last solve, starting from the initial one */
+    const std::vector<double>& get_residual_history() const {
+        return residual_history;
+    }
+
+    /** Copy the iterations and residuals of the last solve into the statistics */
+    void fill(SolveStats &stats) const;
+
+private:
+    std::vector<double> residual_history;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_SOLVER_STATS_H_ */
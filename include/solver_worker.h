@@ -0,0 +1,95 @@
+/*
+ * solver_worker.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SOLVER_WORKER_H_
+#define INCLUDE_SOLVER_WORKER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace fch {
+
+/** @brief Flag for stopping a running solve cooperatively.
+ * The solver checks it between the Newton iterations or time steps and returns the statistics
+ * of the work done so far.
+ */
+class CancellationToken {
+public:
+    CancellationToken() :
+            cancelled(false) {
+    }
+
+    /** Requests the solve to stop; can be called from any thread */
+    void cancel() {
+        cancelled.store(true, std::memory_order_release);
+    }
+
+    /** Clears the request for the next solve */
+    void reset() {
+        cancelled.store(false, std::memory_order_release);
+    }
+
+    bool is_cancelled() const {
+        return cancelled.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> cancelled;
+};
+
+/** @brief Thread that runs the submitted jobs one after another in the submission order.
+ *
+ * The asynchronous solver methods (run_async etc.) submit themselves to the worker of the solver
+ * and return a future of their result; exceptions thrown by the job are rethrown by future::get().
+ * The thread is started with the first job, and the destructor finishes the queued jobs before joining it.
+ */
+class SolverWorker {
+public:
+    SolverWorker();
+    ~SolverWorker();
+
+    SolverWorker(const SolverWorker &) = delete;
+    SolverWorker& operator=(const SolverWorker &) = delete;
+
+    /** Queues the job and returns the future of its result */
+    template<typename Function>
+    std::future<typename std::result_of<Function()>::type> submit(Function job) {
+        typedef typename std::result_of<Function()>::type Result;
+        // packaged_task is move-only, the queue holds copyable functions
+        std::shared_ptr<std::packaged_task<Result()> > task(new std::packaged_task<Result()>(job));
+        std::future<Result> result = task->get_future();
+        enqueue([task]() {
+            (*task)();
+        });
+        return result;
+    }
+
+    /** Number of jobs queued or running */
+    unsigned int n_pending() const;
+
+private:
+    void enqueue(std::function<void()> job);
+
+    /** Loop of the worker thread */
+    void work();
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()> > jobs;
+    unsigned int running;           ///< 1 while a job is running
+    bool stopping;
+    std::thread thread;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_SOLVER_WORKER_H_ */
@@ -0,0 +1,42 @@
+/*
+ * sparsity_builder.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SPARSITY_BUILDER_H_
+#define INCLUDE_SPARSITY_BUILDER_H_
+
+#include <deal.II/dofs/dof_handler.h>
+#include <deal.II/lac/constraint_matrix.h>
+#include <deal.II/lac/sparsity_pattern.h>
+
+namespace fch {
+
+using namespace dealii;
+
+/**
+ * Builds the same pattern as DoFTools::make_sparsity_pattern(dof_handler, dsp, constraints, false)
+ * followed by sparsity.copy_from(dsp), but without the DynamicSparsityPattern intermediate.
+ *
+ * The dof indices of the cells are stored once and inverted into a row -> cells map.
+ * A first pass over the rows counts the exact number of distinct columns,
+ * the second one fills the static pattern allocated with these row lengths.
+ * The scratch data is a few integers per cell dof, so the peak memory is
+ * about one static pattern instead of a dynamic plus a static one.
+ *
+ * @param dof_handler  dof handler with distributed dofs
+ * @param constraints  closed constraints; the constrained rows keep only the diagonal entry
+ * @param sparsity     resulting compressed pattern
+ */
+template<int dim>
+void make_static_sparsity_pattern(const DoFHandler<dim> &dof_handler,
+        const ConstraintMatrix &constraints, SparsityPattern &sparsity);
+
+/** Same as above without constraints */
+template<int dim>
+void make_static_sparsity_pattern(const DoFHandler<dim> &dof_handler, SparsityPattern &sparsity);
+
+} // namespace fch
+
+#endif /* INCLUDE_SPARSITY_BUILDER_H_ */
@@ -0,0 +1,74 @@
+/*
+ * ssor_tuner.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SSOR_TUNER_H_
+#define INCLUDE_SSOR_TUNER_H_
+
+namespace fch {
+
+/** @brief Online tuning of the SSOR relaxation parameter omega of a preconditioned CG.
+ *
+ * The first solves of a matrix are used for a golden-section search of omega that minimises
+ * the CG iterations. As the cost of an SSOR-CG iteration does not depend on omega,
+ * the iterations are proportional to the solve time. After the search the best omega is locked in.
+ * If the iterations of a later solve grow clearly above their running average
+ * (e.g. because the matrix changed with the temperature), the search is restarted.
+ *
+ * Usage: solve with get_omega() and pass the resulting iterations to add_result(); a solve that
+ * did not converge is reported with its maximum number of iterations.
+ */
+class SSORTuner {
+public:
+    /**
+     * @param omega_min          lower end of the searched interval
+     * @param omega_max          upper end of the searched interval
+     * @param max_search_solves  number of solves after which the search is stopped
+     * @param drift_tolerance    relative growth of the iterations above their average that restarts the search
+     */
+    SSORTuner(const double omega_min = 1.0, const double omega_max = 1.9,
+            const unsigned int max_search_solves = 8, const double drift_tolerance = 0.3);
+
+    /** Relaxation parameter to use in the next solve */
+    double get_omega() const {
+        return omega;
+    }
+
+    /** Reports the CG iterations of the solve that used get_omega() */
+    void add_result(const unsigned int iterations);
+
+    /** Whether the search is finished and omega is locked in */
+    bool is_locked() const {
+        return locked;
+    }
+
+    /** Starts a new search over the whole interval */
+    void restart();
+
+private:
+    /** Stop the search and use the best omega found */
+    void lock();
+
+    double omega_min, omega_max;
+    unsigned int max_search_solves;
+    double drift_tolerance;
+
+    double omega;                   ///< omega of the next solve
+    bool locked;
+
+    // golden-section search state
+    double lower, upper;            ///< bracket of the minimum
+    double x1, x2;                  ///< inner points, x1 < x2
+    double f1, f2;                  ///< iterations at the inner points, negative if not evaluated yet
+    unsigned int n_evaluations;
+    double best_omega;
+    double best_iterations;
+
+    double average_iterations;      ///< running average of the iterations after locking
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_SSOR_TUNER_H_ */
@@ -0,0 +1,97 @@
+/*
+ * trace_recorder.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_TRACE_RECORDER_H_
+#define INCLUDE_TRACE_RECORDER_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fch {
+
+/** @brief Records the timeline of the solver phases in the Chrome trace-event format.
+ *
+ * Spans are nested per thread (begin/end pairs), counters record values such as
+ * CG iterations or residuals over time. The written JSON file opens directly
+ * in chrome://tracing and in Perfetto (ui.perfetto.dev).
+ * All methods are thread safe.
+ */
+class TraceRecorder {
+public:
+    TraceRecorder();
+
+    /** Opens a span on the calling thread; the names are copied only here, when recording */
+    void begin(const char *name, const char *category = "fch");
+
+    /** Closes the innermost open span of the calling thread */
+    void end();
+
+    /** Records the value of a counter track */
+    void counter(const char *name, const double value);
+
+    /** Records a zero-length marker on the calling thread */
+    void instant(const char *name, const char *category = "fch");
+
+    /** Name of the calling thread in the viewer */
+    void set_thread_name(const std::string &name);
+
+    /** Forgets the recorded events; the time origin is kept */
+    void clear();
+
+    /** Number of recorded events */
+    std::size_t size() const;
+
+    /**
+     * Writes the events in the trace-event JSON format
+     * @return true if success, otherwise false
+     */
+    bool write(const std::string &file_name) const;
+
+    /** @brief Span that lasts until the end of the scope.
+     * A NULL recorder disables it, and then the scope costs only a pointer check. */
+    class Scope {
+    public:
+        Scope(TraceRecorder *recorder, const char *name, const char *category = "fch");
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope& operator=(const Scope &) = delete;
+
+    private:
+        TraceRecorder *recorder;
+    };
+
+private:
+    struct Event {
+        char phase;             ///< B(egin), E(nd), C(ounter), i(nstant)
+        unsigned int thread;
+        double timestamp;       ///< microseconds since the construction of the recorder
+        double value;           ///< value of the counter
+        std::string name;
+        std::string category;
+    };
+
+    /** Record the event; the mutex must be held */
+    void add_event(const char phase, const char *name, const char *category, const double value);
+
+    /** Small sequential id of the calling thread; the mutex must be held */
+    unsigned int thread_id();
+
+    std::chrono::steady_clock::time_point start;
+
+    mutable std::mutex mutex;
+    std::vector<Event> events;
+    std::map<std::thread::id, unsigned int> thread_ids;
+    std::map<unsigned int, std::string> thread_names;
+};
+
+} // namespace fch
+
+#endif /* INCLUDE_TRACE_RECORDER_H_ */
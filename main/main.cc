@@ -16,8 +16,12 @@
 #include "physical_quantities.h"
 #include "currents_and_heating.h"
 #include "currents_and_heating_stationary.h"
+#include "mesh_generator.h"
+#include "trace_recorder.h"
+#include "solver_service.h"
+#include "coupled_pipeline.h"
 
-int main() {
+int main(int argc, char **argv) {
 
     dealii::Timer timer;
 
@@ -55,16 +59,39 @@ int main() {
         timer.restart();
     }
 
+    // Persistent 3d solver service for coupled codes: ./main --service <socket path>
+    // or ./main --service - for requests on stdin and replies on stdout
+    if (argc > 2 && std::string(argv[1]) == "--service") {
+        fch::SolverService<3> service(&pq);
+        const std::string path = argv[2];
+        if (path == "-") {
+            // the replies own stdout
+            std::streambuf *cout_buffer = std::cout.rdbuf(std::cerr.rdbuf());
+            service.serve_connection(0, 1);
+            std::cout.rdbuf(cout_buffer);
+            return EXIT_SUCCESS;
+        }
+        std::cout << "    Serving requests on " << path << std::endl;
+        return service.serve(path) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
 
 // Transient example
 
+    // Timeline of the solver phases for chrome://tracing or Perfetto, enabled with FCH_TRACE=<file.json>
+    const char *trace_file = std::getenv("FCH_TRACE");
+    fch::TraceRecorder tracer;
+    fch::TraceRecorder *trace = trace_file ? &tracer : NULL;
+
     fch::Laplace<2> laplace;
+    laplace.set_trace_recorder(trace);
     laplace.import_mesh_from_file("../res/2d_meshes/vacuum_aligned.msh");
     laplace.set_applied_efield(10.0);
     laplace.run();
 
     double time_step = 0.1e-15; // seconds
     fch::CurrentsAndHeating<2> ch(time_step, &pq);
+    ch.set_trace_recorder(trace);
     ch.import_mesh_from_file("../res/2d_meshes/copper_aligned.msh");
 
     ch.setup_current_system();
@@ -76,19 +103,10 @@ int main() {
     for (double time = 0.0; time <= 3.0e-15; ) {
         time+=time_step;
 
-        ch.assemble_current_system();
-        unsigned int ccg = ch.solve_current();
-
-        if (i == 0) {
-            ch.assemble_heating_system_euler_implicit();
-        } else {
-            //ch.assemble_heating_system_euler_implicit();
-            ch.assemble_heating_system_crank_nicolson();
-        }
-
-        unsigned int hcg = ch.solve_heat();
-        double max_T = ch.get_max_temperature();
-        std::printf("    t=%5.3ffs; ccg=%2d; hcg=%2d; max_T=%6.2f\n", time*1e15, ccg, hcg, max_T);
+        // implicit Euler in the first step, Crank-Nicolson afterwards
+        const fch::StepStats stats = ch.do_time_step(i == 0);
+        std::printf("    t=%5.3ffs; ccg=%2d; hcg=%2d; max_T=%6.2f\n", time*1e15,
+                stats.current.iterations, stats.heat.iterations, stats.peak_temperature);
 
         if (i%10 == 0) {
             ch.output_results_current("./output/current_solution-"+std::to_string(i)+".vtk");
@@ -97,6 +115,9 @@ int main() {
         i++;
     }
 
+    if (trace_file)
+        tracer.write(trace_file);
+
 
 // Simple Stationary 3d usage //
 /*
@@ -178,7 +199,7 @@ int main() {
                 c_mesh_imp_time, c_mesh_exp_time);
 
         double final_error = ch_solver->run_specific(1.0, 100, true,
-                "output/sol_" + std::to_string(n), true, 2.0);
+                "output/sol_" + std::to_string(n), true, 2.0).temperature_error;
 
         std::cout << "    Solved currents&heating: " << timer.wall_time()
                 << " s" << std::endl;
@@ -197,6 +218,28 @@ int main() {
     }
 */
 
+// Stationary 3d iterations with overlapping stages //
+/*
+    // Laplace and copper setup of step n+1 and the output of step n-1 run during the Newton iterations of step n
+    fch::CoupledPipeline<3> pipeline(&pq);
+    pipeline.set_newton_parameters(1.0, 100, 2.0);
+
+    std::vector<fch::CoupledPipeline<3>::StepInput> steps(4);
+    for (int n = 0; n < 4; n++) {
+        steps[n].vacuum_mesh = res_path + "/3d_meshes/vacuum_" + std::to_string(n) + ".msh";
+        steps[n].copper_mesh = res_path + "/3d_meshes/copper_" + std::to_string(n) + ".msh";
+        steps[n].applied_efield = 1.5;
+        steps[n].field_output = "output/field_sol_" + std::to_string(n) + ".vtk";
+        steps[n].solution_output = "output/sol_" + std::to_string(n) + ".vtk";
+    }
+
+    for (const auto &step : pipeline.run(steps))
+        printf("    step %d: field %5.2f s, copper %5.2f s, newton %5.2f s (%d iter), output %5.2f s\n",
+                step.step, step.field_time, step.copper_time, step.heating.wall_time,
+                step.heating.iterations, step.output_time);
+    std::cout << "    Pipelined iterations: " << timer.wall_time() << " s" << std::endl;
+*/
+
 // 3d mushroom //
     /*
      fch::Laplace<3> laplace_solver;
@@ -239,6 +282,25 @@ int main() {
      mesh_preparer.output_mesh(&new_mesh, "simple_copper.msh");
      */
 
+// Generated 3d nanotip meshes for scaling studies //
+    /*
+     fch::MeshGenerator<3> mesh_generator;
+     mesh_generator.set_tip(20.0, 3.0);
+     mesh_generator.set_box(80.0, 100.0, 40.0);
+     mesh_generator.set_grading(1.5, 1.5);
+     mesh_generator.set_target_cells(1000000);
+
+     fch::Laplace<3> laplace_solver;
+     mesh_generator.generate_vacuum_mesh(laplace_solver.get_triangulation());
+     laplace_solver.set_applied_efield(1.5);
+     laplace_solver.run();
+
+     fch::CurrentsAndHeatingStationary<3> ch_solver(&pq, &laplace_solver);
+     mesh_generator.generate_copper_mesh(ch_solver.get_triangulation());
+     ch_solver.setup_system();
+     ch_solver.run_specific(1.0, 100, false, "output/sol", true, 2.0);
+     */
+
 // Merged mesh fch usage //
     /*
      MeshPreparer<2> mesh_preparer_fch;
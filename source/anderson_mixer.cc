@@ -0,0 +1,85 @@
+/*
+ * anderson_mixer.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/lac/full_matrix.h>
+
+#include "anderson_mixer.h"
+
+namespace fch {
+using namespace dealii;
+
+AndersonMixer::AndersonMixer(const unsigned int depth, const double mixing) :
+        depth(depth), mixing(mixing), has_previous(false) {
+}
+
+void AndersonMixer::reinit(const unsigned int depth_, const double mixing_) {
+    depth = depth_;
+    mixing = mixing_;
+    clear();
+}
+
+void AndersonMixer::clear() {
+    delta_f.clear();
+    delta_g.clear();
+    has_previous = false;
+}
+
+void AndersonMixer::update(Vector<double> &x, const Vector<double> &g) {
+    Assert(x.size() == g.size(), ExcDimensionMismatch(x.size(), g.size()));
+
+    residual = g;
+    residual -= x;
+
+    if (has_previous && depth > 0) {
+        delta_f.push_back(residual);
+        delta_f.back() -= previous_residual;
+        delta_g.push_back(g);
+        delta_g.back() -= previous_g;
+
+        if (delta_f.size() > depth) {
+            delta_f.pop_front();
+            delta_g.pop_front();
+        }
+    }
+
+    previous_residual = residual;
+    previous_g = g;
+    has_previous = true;
+
+    const unsigned int m = delta_f.size();
+
+    // Least squares fit of the residual with the residual differences via the normal equations
+    Vector<double> gamma(m);
+    if (m > 0) {
+        FullMatrix<double> normal_matrix(m, m);
+        Vector<double> normal_rhs(m);
+        double trace = 0.0;
+        for (unsigned int i = 0; i < m; ++i) {
+            normal_rhs(i) = delta_f[i] * residual;
+            for (unsigned int j = 0; j <= i; ++j) {
+                normal_matrix(i, j) = normal_matrix(j, i) = delta_f[i] * delta_f[j];
+            }
+            trace += normal_matrix(i, i);
+        }
+
+        // small regularisation keeps the system solvable if the differences are nearly parallel
+        for (unsigned int i = 0; i < m; ++i)
+            normal_matrix(i, i) += 1e-12 * trace + 1e-300;
+
+        normal_matrix.gauss_jordan();
+        normal_matrix.vmult(gamma, normal_rhs);
+    }
+
+    // x_new = (g - dG gamma) - (1 - mixing) * (f - dF gamma)
+    x = g;
+    x.add(mixing - 1.0, residual);
+    for (unsigned int i = 0; i < m; ++i) {
+        x.add(-gamma(i), delta_g[i]);
+        x.add((1.0 - mixing) * gamma(i), delta_f[i]);
+    }
+}
+
+} // namespace fch
@@ -0,0 +1,173 @@
+/*
+ * coupled_pipeline.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/base/timer.h>
+
+#include "coupled_pipeline.h"
+
+namespace fch {
+
+template<int dim>
+CoupledPipeline<dim>::CoupledPipeline(PhysicalQuantities *pq_) :
+        pq(pq_), tracer(NULL), temperature_tolerance(1.0), max_newton_iter(100), sor_alpha(1.0) {
+}
+
+template<int dim>
+CoupledPipeline<dim>::~CoupledPipeline() {
+    wait();
+}
+
+template<int dim>
+void CoupledPipeline<dim>::set_newton_parameters(const double temperature_tolerance_,
+        const int max_newton_iter_, const double sor_alpha_) {
+    temperature_tolerance = temperature_tolerance_;
+    max_newton_iter = max_newton_iter_;
+    sor_alpha = sor_alpha_;
+}
+
+template<int dim>
+void CoupledPipeline<dim>::set_trace_recorder(TraceRecorder *recorder) {
+    tracer = recorder;
+}
+
+template<int dim>
+std::shared_future<typename CoupledPipeline<dim>::StepResult> CoupledPipeline<dim>::add_step(
+        const StepInput &input) {
+    const unsigned int n = steps.size();
+    Step *previous = n > 0 ? &steps[n - 1] : NULL;
+    std::shared_future<NewtonStats> throttle;
+    if (n > 1)
+        throttle = steps[n - 2].newton;
+
+    steps.emplace_back();
+    Step *step = &steps.back();
+
+    // The initial condition is interpolated from the previous step, which is freed only
+    // in the output stage of this step
+    step->laplace.reset(new Laplace<dim>());
+    step->laplace->set_trace_recorder(tracer);
+    if (previous)
+        step->ch.reset(new CurrentsAndHeatingStationary<dim>(pq, step->laplace.get(), previous->ch.get()));
+    else
+        step->ch.reset(new CurrentsAndHeatingStationary<dim>(pq, step->laplace.get()));
+    step->ch->set_trace_recorder(tracer);
+
+    Laplace<dim> *laplace = step->laplace.get();
+    CurrentsAndHeatingStationary<dim> *ch = step->ch.get();
+    TraceRecorder *trace_recorder = tracer;
+
+    // the stages of the same kind run in the order of the steps on their worker
+    step->field = field_worker.submit([=]() {
+        if (throttle.valid())
+            throttle.wait();
+        TraceRecorder::Scope trace(trace_recorder, "pipeline_field");
+        Timer timer;
+
+        laplace->import_mesh_from_file(input.vacuum_mesh);
+        laplace->set_applied_efield(input.applied_efield);
+        laplace->setup_system();
+        laplace->assemble_system();
+        const SolveStats stats = laplace->solve();
+
+        step->field_time = timer.wall_time();
+        return stats;
+    }).share();
+
+    step->copper = copper_worker.submit([=]() {
+        if (throttle.valid())
+            throttle.wait();
+        TraceRecorder::Scope trace(trace_recorder, "pipeline_copper");
+        Timer timer;
+
+        ch->import_mesh_from_file(input.copper_mesh);
+        ch->setup_system();
+
+        step->copper_time = timer.wall_time();
+    }).share();
+
+    std::shared_future<SolveStats> field = step->field;
+    std::shared_future<void> copper = step->copper;
+    std::shared_future<NewtonStats> previous_newton;
+    if (previous)
+        previous_newton = previous->newton;
+    const double tolerance = temperature_tolerance;
+    const int max_iter = max_newton_iter;
+    const double alpha = sor_alpha;
+
+    step->newton = newton_worker.submit([=]() {
+        field.get();
+        copper.get();
+        // the initial condition needs the solution of the previous step; it ran earlier on this
+        // worker, so this only rethrows its exception
+        if (previous_newton.valid())
+            previous_newton.get();
+        TraceRecorder::Scope trace(trace_recorder, "pipeline_newton");
+
+        return ch->run_specific(tolerance, max_iter, false, "", false, alpha);
+    }).share();
+
+    std::shared_future<NewtonStats> newton = step->newton;
+
+    step->output = output_worker.submit([=]() {
+        StepResult result;
+        result.heating = newton.get();
+        TraceRecorder::Scope trace(trace_recorder, "pipeline_output");
+        Timer timer;
+
+        if (!input.field_output.empty())
+            laplace->output_results(input.field_output);
+        if (!input.solution_output.empty())
+            ch->output_results(input.solution_output);
+        result.output_time = timer.wall_time();
+
+        // Nothing uses the previous step any more: its Newton iterations and output (earlier on
+        // this worker) are done and this step has interpolated its initial condition
+        if (previous) {
+            previous->ch.reset();
+            previous->laplace.reset();
+        }
+
+        result.step = n;
+        result.field = field.get();
+        result.field_time = step->field_time;
+        result.copper_time = step->copper_time;
+        return result;
+    }).share();
+
+    return step->output;
+}
+
+template<int dim>
+std::vector<typename CoupledPipeline<dim>::StepResult> CoupledPipeline<dim>::run(
+        const std::vector<StepInput> &inputs) {
+    std::vector<std::shared_future<StepResult> > results;
+    for (const StepInput &input : inputs)
+        results.push_back(add_step(input));
+
+    std::vector<StepResult> stats;
+    for (auto &result : results)
+        stats.push_back(result.get());
+    return stats;
+}
+
+template<int dim>
+void CoupledPipeline<dim>::wait() const {
+    for (const Step &step : steps) {
+        if (step.field.valid())
+            step.field.wait();
+        if (step.copper.valid())
+            step.copper.wait();
+        if (step.newton.valid())
+            step.newton.wait();
+        if (step.output.valid())
+            step.output.wait();
+    }
+}
+
+template class CoupledPipeline<2> ;
+template class CoupledPipeline<3> ;
+
+} // namespace fch
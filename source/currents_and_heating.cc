@@ -37,6 +37,8 @@
 #include <algorithm>
 
 #include "currents_and_heating.h"
+#include "element_kernels.h"
+#include "sparsity_builder.h"
 #include "utility.h"
 
 namespace fch {
@@ -46,14 +48,22 @@ template<int dim>
 CurrentsAndHeating<dim>::CurrentsAndHeating() :
         time_step(1e-13), uniform_efield_bc(1.0),
         fe_current(currents_degree), dof_handler_current(triangulation),
-        fe_heat(heating_degree), dof_handler_heat(triangulation), pq(NULL) {
+        fe_heat(heating_degree), dof_handler_heat(triangulation),
+        matrix_free_heating(false), heat_system_matrix_free(false), solver_cg(solver_control),
+        ssor_autotuning(false), mixed_precision(MixedPrecisionCG::off), pq(NULL), tracer(NULL),
+        efield_array(NULL), emission_current_array(NULL), nottingham_array(NULL),
+        n_time_steps(0), cancellation(NULL) {
 }
 
 template<int dim>
 CurrentsAndHeating<dim>::CurrentsAndHeating(double time_step_, PhysicalQuantities *pq_) :
         time_step(time_step_), uniform_efield_bc(1.0),
         fe_current(currents_degree), dof_handler_current(triangulation),
-        fe_heat(heating_degree), dof_handler_heat(triangulation), pq(pq_) {
+        fe_heat(heating_degree), dof_handler_heat(triangulation),
+        matrix_free_heating(false), heat_system_matrix_free(false), solver_cg(solver_control),
+        ssor_autotuning(false), mixed_precision(MixedPrecisionCG::off), pq(pq_), tracer(NULL),
+        efield_array(NULL), emission_current_array(NULL), nottingham_array(NULL),
+        n_time_steps(0), cancellation(NULL) {
 }
 
 template<int dim>
@@ -88,14 +98,19 @@ bool CurrentsAndHeating<dim>::import_mesh_directly(std::vector<Point<dim> > vert
 
 template<int dim>
 void CurrentsAndHeating<dim>::setup_current_system() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::setup_current_system");
 
     dof_handler_current.distribute_dofs(fe_current);
     //std::cout << "Number of degrees of freedom: " << dof_handler.n_dofs()
     //      << std::endl;
 
-    DynamicSparsityPattern dsp(dof_handler_current.n_dofs());
-    DoFTools::make_sparsity_pattern(dof_handler_current, dsp);
-    sparsity_pattern_current.copy_from(dsp);
+    // Zero potential at the copper bottom
+    current_constraints.clear();
+    VectorTools::interpolate_boundary_values(dof_handler_current, BoundaryId::copper_bottom,
+            ZeroFunction<dim>(), current_constraints);
+    current_constraints.close();
+
+    make_static_sparsity_pattern(dof_handler_current, current_constraints, sparsity_pattern_current);
 
     system_matrix_current.reinit(sparsity_pattern_current);
 
@@ -107,18 +122,36 @@ void CurrentsAndHeating<dim>::setup_current_system() {
         solution_current[i] = 0;
         old_solution_current[i] = 0;
     }
+
+    current_scratch.reset(new CurrentScratch(fe_current, fe_heat));
+
+    // Position of the surface faces in the externally given boundary condition arrays
+    surface_face_index.clear();
+    unsigned int face_index = 0;
+    typename DoFHandler<dim>::active_cell_iterator cell;
+    for (cell = dof_handler_current.begin_active(); cell != dof_handler_current.end(); ++cell)
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+            if (cell->face(f)->boundary_id() == BoundaryId::copper_surface)
+                surface_face_index[std::pair<unsigned, unsigned>(cell->index(), f)] = face_index++;
+
+    memory_report.record_phase("setup_current");
 }
 
 template<int dim>
 void CurrentsAndHeating<dim>::setup_heating_system() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::setup_heating_system");
 
     dof_handler_heat.distribute_dofs(fe_heat);
     //std::cout << "Number of degrees of freedom: " << dof_handler.n_dofs()
     //      << std::endl;
 
-    DynamicSparsityPattern dsp(dof_handler_heat.n_dofs());
-    DoFTools::make_sparsity_pattern(dof_handler_heat, dsp);
-    sparsity_pattern_heat.copy_from(dsp);
+    // Ambient temperature at the copper bottom
+    heat_constraints.clear();
+    VectorTools::interpolate_boundary_values(dof_handler_heat, BoundaryId::copper_bottom,
+            ConstantFunction<dim>(ambient_temperature), heat_constraints);
+    heat_constraints.close();
+
+    make_static_sparsity_pattern(dof_handler_heat, heat_constraints, sparsity_pattern_heat);
 
     system_matrix_heat.reinit(sparsity_pattern_heat);
 
@@ -132,43 +165,65 @@ void CurrentsAndHeating<dim>::setup_heating_system() {
         solution_heat[i] = ambient_temperature;
         old_solution_heat[i] = ambient_temperature;
     }
+
+    // Lifting for the matrix-free operator, which is initialized on first use
+    heat_lift.reinit(dof_handler_heat.n_dofs());
+    heat_constraints.distribute(heat_lift);
+
+    heat_operator.clear();
+    heat_system_matrix_free = false;
+
+    heat_scratch.reset(new HeatScratch(fe_heat, fe_current));
+    heat_scratch->lifted_rhs.reinit(dof_handler_heat.n_dofs());
+    heat_scratch->homogeneous_solution.reinit(dof_handler_heat.n_dofs());
+
+    typename HeatChebyshev::AdditionalData &chebyshev_data = heat_scratch->chebyshev_data;
+    chebyshev_data.degree = 4;
+    chebyshev_data.smoothing_range = 20.0;
+    chebyshev_data.eig_cg_n_iterations = 12;
+    chebyshev_data.matrix_diagonal_inverse.reinit(dof_handler_heat.n_dofs());
+
+    memory_report.record_phase("setup_heating");
 }
 
 template<int dim>
 void CurrentsAndHeating<dim>::assemble_current_system() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::assemble_current_system");
 
     system_matrix_current = 0;
     system_rhs_current = 0;
 
-    QGauss<dim> quadrature_formula(currents_degree+1);
-    QGauss<dim-1> face_quadrature_formula(currents_degree+1);
+    // The finite element values and buffers are created in setup_current_system
+    Assert(current_scratch, ExcNotInitialized());
+    CurrentScratch &scratch = *current_scratch;
 
     // Current finite element values
-    FEValues<dim> fe_values(fe_current, quadrature_formula,
-            update_gradients | update_quadrature_points | update_JxW_values);
-    FEFaceValues<dim> fe_face_values(fe_current, face_quadrature_formula,
-                update_values | update_quadrature_points | update_JxW_values);
+    FEValues<dim> &fe_values = scratch.fe_values;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
 
     // Temperature finite element values (only for accessing previous iteration solution)
-    FEValues<dim> fe_values_heat(fe_heat, quadrature_formula,
-            update_values);
-    FEFaceValues<dim> fe_face_values_heat(fe_heat, face_quadrature_formula,
-                update_values);
+    FEValues<dim> &fe_values_heat = scratch.fe_values_heat;
+    FEFaceValues<dim> &fe_face_values_heat = scratch.fe_face_values_heat;
 
-    const unsigned int dofs_per_cell = fe_current.dofs_per_cell;
-    const unsigned int n_q_points = quadrature_formula.size();
-    const unsigned int n_face_q_points = face_quadrature_formula.size();
+    // Fixed size local matrices with the element size known at compile time
+    typedef ElementKernel<dim, currents_degree> Kernel;
+    Kernel &kernel = scratch.kernel;
 
-    FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> cell_rhs(dofs_per_cell);
+    const unsigned int dofs_per_cell = Kernel::dofs_per_cell;
+    const unsigned int n_q_points = Kernel::n_q_points;
+    const unsigned int n_face_q_points = scratch.face_quadrature.size();
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    typename Kernel::LocalMatrix cell_matrix;
+    typename Kernel::LocalVector cell_rhs;
+    typename Kernel::QuadratureValues sigma_values;
+
+    std::vector<types::global_dof_index> &local_dof_indices = scratch.local_dof_indices;
 
     // ---------------------------------------------------------------------------------------------
     // The previous solution values in the cell quadrature points
-    std::vector<double> prev_sol_temperature_values(n_q_points);
+    std::vector<double> &prev_sol_temperature_values = scratch.temperature_values;
     // The previous solution values in the face quadrature points
-    std::vector<double> prev_sol_face_temperature_values(n_face_q_points);
+    std::vector<double> &prev_sol_face_temperature_values = scratch.face_temperature_values;
     // ---------------------------------------------------------------------------------------------
 
     typename DoFHandler<dim>::active_cell_iterator cell = dof_handler_current.begin_active(),
@@ -177,8 +232,9 @@ void CurrentsAndHeating<dim>::assemble_current_system() {
 
     for (; cell != endc; ++cell, ++heat_cell) {
         fe_values.reinit(cell);
-        cell_matrix = 0;
-        cell_rhs = 0;
+        kernel.reinit(fe_values, false, true);
+        cell_matrix.fill(0.0);
+        cell_rhs.fill(0.0);
 
         fe_values_heat.reinit(heat_cell);
         fe_values_heat.get_function_values(solution_heat, prev_sol_temperature_values);
@@ -186,17 +242,10 @@ void CurrentsAndHeating<dim>::assemble_current_system() {
         // ----------------------------------------------------------------------------------------
         // Local matrix assembly
         // ----------------------------------------------------------------------------------------
-        for (unsigned int q = 0; q < n_q_points; ++q) {
+        for (unsigned int q = 0; q < n_q_points; ++q)
+            sigma_values[q] = pq->sigma(prev_sol_temperature_values[q]);
 
-            double temperature = prev_sol_temperature_values[q];
-            double sigma = pq->sigma(temperature);
-
-            for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                    cell_matrix(i, j) += (fe_values.shape_grad(i, q) * fe_values.shape_grad(j, q)
-                            * sigma * fe_values.JxW(q));
-            }
-        }
+        kernel.add_stiffness(sigma_values, cell_matrix);
         // ----------------------------------------------------------------------------------------
         // Local right-hand side assembly
         // ----------------------------------------------------------------------------------------
@@ -220,7 +269,7 @@ void CurrentsAndHeating<dim>::assemble_current_system() {
                     double emission_current = get_emission_current_bc(cop_cell_info, temperature);
 
                     for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                        cell_rhs(i) += (fe_face_values.shape_value(i, q)
+                        cell_rhs[i] += (fe_face_values.shape_value(i, q)
                                 * emission_current * fe_face_values.JxW(q));
                     }
                 }
@@ -228,70 +277,72 @@ void CurrentsAndHeating<dim>::assemble_current_system() {
         }
 
         cell->get_dof_indices(local_dof_indices);
-        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-            for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                system_matrix_current.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
-
-            system_rhs_current(local_dof_indices[i]) += cell_rhs(i);
-        }
+        kernel.distribute_local_to_global(cell_matrix, cell_rhs, local_dof_indices,
+                current_constraints, system_matrix_current, system_rhs_current);
     }
-
-    std::map<types::global_dof_index, double> boundary_values;
-    VectorTools::interpolate_boundary_values(dof_handler_current, BoundaryId::copper_bottom,
-            ZeroFunction<dim>(), boundary_values);
-    MatrixTools::apply_boundary_values(boundary_values, system_matrix_current, solution_current, system_rhs_current);
 }
 
 
 template<int dim>
 void CurrentsAndHeating<dim>::assemble_heating_system_crank_nicolson() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::assemble_heating_system_crank_nicolson");
 
     const double gamma = cu_rho_cp/time_step;
 
-    system_matrix_heat = 0;
+    // In the matrix-free case only the right-hand side is assembled
+    heat_system_matrix_free = matrix_free_heating;
+
+    if (!heat_system_matrix_free)
+        system_matrix_heat = 0;
     system_rhs_heat = 0;
 
-    QGauss<dim> quadrature_formula(heating_degree+1);
-    QGauss<dim-1> face_quadrature_formula(heating_degree+1);
+    // The finite element values and buffers are created in setup_heating_system
+    Assert(heat_scratch, ExcNotInitialized());
+    HeatScratch &scratch = *heat_scratch;
 
     // Heating finite element values
-    FEValues<dim> fe_values(fe_heat, quadrature_formula,
-            update_values | update_gradients
-            | update_quadrature_points | update_JxW_values);
-    FEFaceValues<dim> fe_face_values(fe_heat, face_quadrature_formula,
-                update_values | update_quadrature_points | update_JxW_values);
+    FEValues<dim> &fe_values = scratch.fe_values;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
 
     // Finite element values for accessing current calculation
-    FEValues<dim> fe_values_current(fe_current, quadrature_formula,
-            update_gradients);
+    FEValues<dim> &fe_values_current = scratch.fe_values_current;
 
-    const unsigned int dofs_per_cell = fe_heat.dofs_per_cell;
-    const unsigned int n_q_points = quadrature_formula.size();
-    const unsigned int n_face_q_points = face_quadrature_formula.size();
+    // Fixed size local matrices with the element size known at compile time
+    typedef ElementKernel<dim, heating_degree> Kernel;
+    Kernel &kernel = scratch.kernel;
 
-    FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> cell_rhs(dofs_per_cell);
+    const unsigned int dofs_per_cell = Kernel::dofs_per_cell;
+    const unsigned int n_q_points = Kernel::n_q_points;
+    const unsigned int n_face_q_points = scratch.face_quadrature.size();
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    typename Kernel::LocalMatrix cell_matrix;
+    typename Kernel::LocalVector cell_rhs;
+    typename Kernel::QuadratureValues mass_coefficient, kappa_values, rhs_coefficient;
+
+    std::vector<types::global_dof_index> &local_dof_indices = scratch.local_dof_indices;
 
     // ---------------------------------------------------------------------------------------------
     // The other solution values in the cell quadrature points
-    std::vector<Tensor<1, dim>> potential_gradients(n_q_points);
-    std::vector<Tensor<1, dim>> prev_sol_potential_gradients(n_q_points);
-    std::vector<double> prev_sol_temperature_values(n_q_points);
-    std::vector<Tensor<1, dim>> prev_sol_temperature_gradients(n_q_points);
+    std::vector<Tensor<1, dim>> &potential_gradients = scratch.potential_gradients;
+    std::vector<Tensor<1, dim>> &prev_sol_potential_gradients = scratch.prev_potential_gradients;
+    std::vector<double> &prev_sol_temperature_values = scratch.temperature_values;
+    std::vector<Tensor<1, dim>> &prev_sol_temperature_gradients = scratch.temperature_gradients;
 
-    std::vector<double> prev_sol_face_temperature_values(n_face_q_points);
+    std::vector<double> &prev_sol_face_temperature_values = scratch.face_temperature_values;
     // ---------------------------------------------------------------------------------------------
 
     typename DoFHandler<dim>::active_cell_iterator cell = dof_handler_heat.begin_active(),
             endc = dof_handler_heat.end();
     typename DoFHandler<dim>::active_cell_iterator current_cell = dof_handler_current.begin_active();
 
+    std::array<Tensor<1, dim>, Kernel::n_q_points> heat_flux;
+    mass_coefficient.fill(2 * gamma);
+
     for (; cell != endc; ++cell, ++current_cell) {
         fe_values.reinit(cell);
-        cell_matrix = 0;
-        cell_rhs = 0;
+        kernel.reinit(fe_values, true, true);
+        cell_matrix.fill(0.0);
+        cell_rhs.fill(0.0);
 
         fe_values.get_function_values(old_solution_heat, prev_sol_temperature_values);
         fe_values.get_function_gradients(old_solution_heat, prev_sol_temperature_gradients);
@@ -314,20 +365,15 @@ void CurrentsAndHeating<dim>::assemble_heating_system_crank_nicolson() {
             double pot_grad_squared = potential_gradients[q].norm_square();
             double prev_pot_grad_squared = prev_sol_potential_gradients[q].norm_square();
 
-            for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                for (unsigned int j = 0; j < dofs_per_cell; ++j) {
-                    cell_matrix(i, j) += (
-                            2*gamma*fe_values.shape_value(i, q) * fe_values.shape_value(j, q) // Mass matrix
-                            + kappa*fe_values.shape_grad(i, q) * fe_values.shape_grad(j, q)
-                    ) * fe_values.JxW(q);
-                }
-                cell_rhs(i) += (
-                        2*gamma*fe_values.shape_value(i, q)*prev_temperature
-                        - kappa*fe_values.shape_grad(i, q)*prev_temperature_grad
-                        + fe_values.shape_value(i, q)*sigma*(pot_grad_squared+prev_pot_grad_squared)
-                ) * fe_values.JxW(q);
-            }
+            // Mass matrix with 2*gamma and stiffness matrix with kappa
+            kappa_values[q] = kappa;
+            rhs_coefficient[q] = 2*gamma*prev_temperature + sigma*(pot_grad_squared+prev_pot_grad_squared);
+            heat_flux[q] = -kappa*prev_temperature_grad;
         }
+        if (!heat_system_matrix_free)
+            kernel.add_mass_stiffness(mass_coefficient, kappa_values, cell_matrix);
+        kernel.add_value_rhs(rhs_coefficient, cell_rhs);
+        kernel.add_gradient_rhs(heat_flux, cell_rhs);
         // ----------------------------------------------------------------------------------------
         // Local right-hand side assembly
         // ----------------------------------------------------------------------------------------
@@ -351,7 +397,7 @@ void CurrentsAndHeating<dim>::assemble_heating_system_crank_nicolson() {
 
                     //nottingham_heat = 0.0;
                     for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                        cell_rhs(i) += (fe_face_values.shape_value(i, q)
+                        cell_rhs[i] += (fe_face_values.shape_value(i, q)
                                 * 2.0 * nottingham_heat * fe_face_values.JxW(q));
                     }
                 }
@@ -359,67 +405,81 @@ void CurrentsAndHeating<dim>::assemble_heating_system_crank_nicolson() {
         }
 
         cell->get_dof_indices(local_dof_indices);
-        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-            for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                system_matrix_heat.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
-
-            system_rhs_heat(local_dof_indices[i]) += cell_rhs(i);
-        }
+        if (heat_system_matrix_free) {
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                system_rhs_heat(local_dof_indices[i]) += cell_rhs[i];
+        } else
+            kernel.distribute_local_to_global(cell_matrix, cell_rhs, local_dof_indices,
+                    heat_constraints, system_matrix_heat, system_rhs_heat);
     }
 
-    std::map<types::global_dof_index, double> boundary_values;
-    VectorTools::interpolate_boundary_values(dof_handler_heat, BoundaryId::copper_bottom,
-            ConstantFunction<dim>(ambient_temperature), boundary_values);
-    MatrixTools::apply_boundary_values(boundary_values, system_matrix_heat, solution_heat, system_rhs_heat);
+    if (heat_system_matrix_free) {
+        // MatrixFree ignores the inhomogeneities, so the operator sees homogeneous constraints
+        if (!heat_operator.initialized())
+            heat_operator.reinit(dof_handler_heat, heat_constraints);
+        heat_operator.set_coefficients(2 * gamma, old_solution_heat, *pq);
+
+        // Move the Dirichlet temperature to the rhs; the operator solves for the homogeneous part
+        heat_operator.apply_lifting(scratch.lifted_rhs, heat_lift);
+        system_rhs_heat -= scratch.lifted_rhs;
+        heat_constraints.set_zero(system_rhs_heat);
+    }
 }
 
 
 template<int dim>
 void CurrentsAndHeating<dim>::assemble_heating_system_euler_implicit() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::assemble_heating_system_euler_implicit");
 
     const double gamma = cu_rho_cp/time_step;
 
+    heat_system_matrix_free = false;
     system_matrix_heat = 0;
     system_rhs_heat = 0;
 
-    QGauss<dim> quadrature_formula(heating_degree+1);
-    QGauss<dim-1> face_quadrature_formula(heating_degree+1);
+    // The finite element values and buffers are created in setup_heating_system
+    Assert(heat_scratch, ExcNotInitialized());
+    HeatScratch &scratch = *heat_scratch;
 
     // Heating finite element values
-    FEValues<dim> fe_values(fe_heat, quadrature_formula,
-            update_values | update_gradients
-            | update_quadrature_points | update_JxW_values);
-    FEFaceValues<dim> fe_face_values(fe_heat, face_quadrature_formula,
-                update_values | update_quadrature_points | update_JxW_values);
+    FEValues<dim> &fe_values = scratch.fe_values;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
 
     // Finite element values for accessing current calculation
-    FEValues<dim> fe_values_current(fe_current, quadrature_formula,
-            update_gradients);
+    FEValues<dim> &fe_values_current = scratch.fe_values_current;
 
-    const unsigned int dofs_per_cell = fe_heat.dofs_per_cell;
-    const unsigned int n_q_points = quadrature_formula.size();
-    const unsigned int n_face_q_points = face_quadrature_formula.size();
+    // Fixed size local matrices with the element size known at compile time
+    typedef ElementKernel<dim, heating_degree> Kernel;
+    Kernel &kernel = scratch.kernel;
 
-    FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> cell_rhs(dofs_per_cell);
+    const unsigned int dofs_per_cell = Kernel::dofs_per_cell;
+    const unsigned int n_q_points = Kernel::n_q_points;
+    const unsigned int n_face_q_points = scratch.face_quadrature.size();
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    typename Kernel::LocalMatrix cell_matrix;
+    typename Kernel::LocalVector cell_rhs;
+    typename Kernel::QuadratureValues mass_coefficient, kappa_values, rhs_coefficient;
+
+    std::vector<types::global_dof_index> &local_dof_indices = scratch.local_dof_indices;
 
     // ---------------------------------------------------------------------------------------------
     // The other solution values in the cell quadrature points
-    std::vector<Tensor<1, dim>> potential_gradients(n_q_points);
-    std::vector<double> prev_sol_temperature_values(n_q_points);
-    std::vector<double> prev_sol_face_temperature_values(n_face_q_points);
+    std::vector<Tensor<1, dim>> &potential_gradients = scratch.potential_gradients;
+    std::vector<double> &prev_sol_temperature_values = scratch.temperature_values;
+    std::vector<double> &prev_sol_face_temperature_values = scratch.face_temperature_values;
     // ---------------------------------------------------------------------------------------------
 
     typename DoFHandler<dim>::active_cell_iterator cell = dof_handler_heat.begin_active(),
             endc = dof_handler_heat.end();
     typename DoFHandler<dim>::active_cell_iterator current_cell = dof_handler_current.begin_active();
 
+    mass_coefficient.fill(gamma);
+
     for (; cell != endc; ++cell, ++current_cell) {
         fe_values.reinit(cell);
-        cell_matrix = 0;
-        cell_rhs = 0;
+        kernel.reinit(fe_values, true, true);
+        cell_matrix.fill(0.0);
+        cell_rhs.fill(0.0);
 
         fe_values.get_function_values(old_solution_heat, prev_sol_temperature_values);
 
@@ -437,21 +497,12 @@ void CurrentsAndHeating<dim>::assemble_heating_system_euler_implicit() {
 
             double pot_grad_squared = potential_gradients[q].norm_square();
 
-            for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                for (unsigned int j = 0; j < dofs_per_cell; ++j) {
-                    cell_matrix(i, j) += (
-                            gamma*fe_values.shape_value(i, q) * fe_values.shape_value(j, q) // Mass matrix
-                            + kappa*fe_values.shape_grad(i, q) * fe_values.shape_grad(j, q)
-                    ) * fe_values.JxW(q);
-                }
-
-                cell_rhs(i) += (
-                        gamma*fe_values.shape_value(i, q)*prev_temperature
-                        + fe_values.shape_value(i, q)*sigma*pot_grad_squared
-                ) * fe_values.JxW(q);
-
-            }
+            // Mass matrix with gamma and stiffness matrix with kappa
+            kappa_values[q] = kappa;
+            rhs_coefficient[q] = gamma*prev_temperature + sigma*pot_grad_squared;
         }
+        kernel.add_mass_stiffness(mass_coefficient, kappa_values, cell_matrix);
+        kernel.add_value_rhs(rhs_coefficient, cell_rhs);
         // ----------------------------------------------------------------------------------------
         // Local right-hand side assembly
         // ----------------------------------------------------------------------------------------
@@ -477,7 +528,7 @@ void CurrentsAndHeating<dim>::assemble_heating_system_euler_implicit() {
                     //nottingham_heat = 0.0;
                     //std::cout << nottingham_heat << std::endl;
                     for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                        cell_rhs(i) += (fe_face_values.shape_value(i, q)
+                        cell_rhs[i] += (fe_face_values.shape_value(i, q)
                                 * nottingham_heat * fe_face_values.JxW(q));
                     }
                 }
@@ -485,61 +536,239 @@ void CurrentsAndHeating<dim>::assemble_heating_system_euler_implicit() {
         }
 
         cell->get_dof_indices(local_dof_indices);
-        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-            for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                system_matrix_heat.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
-            system_rhs_heat(local_dof_indices[i]) += cell_rhs(i);
-        }
+        kernel.distribute_local_to_global(cell_matrix, cell_rhs, local_dof_indices,
+                heat_constraints, system_matrix_heat, system_rhs_heat);
     }
-
-    std::map<types::global_dof_index, double> boundary_values;
-    VectorTools::interpolate_boundary_values(dof_handler_heat, BoundaryId::copper_bottom,
-            ConstantFunction<dim>(ambient_temperature), boundary_values);
-    MatrixTools::apply_boundary_values(boundary_values, system_matrix_heat, solution_heat, system_rhs_heat);
 }
 
 template<int dim>
-unsigned int CurrentsAndHeating<dim>::solve_current(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+SolveStats CurrentsAndHeating<dim>::solve_current(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::solve_current");
+    Timer timer;
+    SolveStats stats;
 
-    SolverControl solver_control(max_iter, tol);
-    SolverCG<> solver(solver_control);
+    const bool tune = pc_ssor && ssor_autotuning;
+    if (tune)
+        ssor_param = ssor_tuner_current.get_omega();
+    if (pc_ssor)
+        stats.ssor_param = ssor_param;
 
-    if (pc_ssor) {
-        PreconditionSSOR<> preconditioner;
-        preconditioner.initialize(system_matrix_current, ssor_param);
-        solver.solve(system_matrix_current, solution_current, system_rhs_current, preconditioner);
-    } else {
-        solver.solve(system_matrix_current, solution_current, system_rhs_current, PreconditionIdentity());
+    try {
+        if (pc_ssor && mixed_precision != MixedPrecisionCG::off) {
+            mixed_precision_cg_current.initialize(system_matrix_current, ssor_param);
+            stats.iterations = mixed_precision_cg_current.solve(mixed_precision,
+                    system_matrix_current, solution_current, system_rhs_current, max_iter, tol);
+            stats.residual_history = mixed_precision_cg_current.get_residual_history();
+            if (!stats.residual_history.empty())
+                stats.residual = stats.residual_history.back();
+        } else {
+            solver_control.set_max_steps(max_iter);
+            solver_control.set_tolerance(tol);
+
+            if (pc_ssor) {
+                preconditioner_ssor.initialize(system_matrix_current, ssor_param);
+                solver_cg.solve(system_matrix_current, solution_current, system_rhs_current, preconditioner_ssor);
+            } else {
+                solver_cg.solve(system_matrix_current, solution_current, system_rhs_current, PreconditionIdentity());
+            }
+            solver_control.fill(stats);
+        }
+    } catch (SolverControl::NoConvergence &) {
+        // the failed omega costs at least max_iter; without the result the search would be stuck on it
+        if (tune)
+            ssor_tuner_current.add_result(max_iter);
+        throw;
     }
 
+    if (tune)
+        ssor_tuner_current.add_result(stats.iterations);
+
+    current_constraints.distribute(solution_current);
+
     old_solution_current = solution_current;
-    return solver_control.last_step();
+    if (tracer) {
+        tracer->counter("ccg", stats.iterations);
+        tracer->counter("ccg_residual", stats.residual);
+        if (pc_ssor)
+            tracer->counter("ccg_ssor_param", stats.ssor_param);
+    }
+    stats.wall_time = timer.wall_time();
+    return stats;
 }
 
 template<int dim>
-unsigned int CurrentsAndHeating<dim>::solve_heat(int max_iter, double tol, bool pc_ssor, double ssor_param) {
-
-    SolverControl solver_control(max_iter, tol);
-    SolverCG<> solver(solver_control);
+SolveStats CurrentsAndHeating<dim>::solve_heat(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::solve_heat");
+    Timer timer;
+    SolveStats stats;
+
+    solver_control.set_max_steps(max_iter);
+    solver_control.set_tolerance(tol);
+
+    if (heat_system_matrix_free) {
+        // solve for the homogeneous part and add the Dirichlet temperature back afterwards
+        Vector<double> &homogeneous_solution = heat_scratch->homogeneous_solution;
+        homogeneous_solution = solution_heat;
+        heat_constraints.set_zero(homogeneous_solution);
+
+        if (pc_ssor) {
+            // same size as in setup_heating_system, so the copy doesn't reallocate
+            typename HeatChebyshev::AdditionalData &chebyshev_data = heat_scratch->chebyshev_data;
+            chebyshev_data.matrix_diagonal_inverse = heat_operator.get_inverse_diagonal();
+
+            preconditioner_chebyshev.initialize(heat_operator, chebyshev_data);
+            solver_cg.solve(heat_operator, homogeneous_solution, system_rhs_heat, preconditioner_chebyshev);
+        } else {
+            solver_cg.solve(heat_operator, homogeneous_solution, system_rhs_heat, PreconditionIdentity());
+        }
+        solver_control.fill(stats);
 
-    if (pc_ssor) {
-        PreconditionSSOR<> preconditioner;
-        preconditioner.initialize(system_matrix_heat, ssor_param);
-        solver.solve(system_matrix_heat, solution_heat, system_rhs_heat, preconditioner);
+        solution_heat = homogeneous_solution;
+        solution_heat += heat_lift;
     } else {
-        solver.solve(system_matrix_heat, solution_heat, system_rhs_heat, PreconditionIdentity());
+        const bool tune = pc_ssor && ssor_autotuning;
+        if (tune)
+            ssor_param = ssor_tuner_heat.get_omega();
+        if (pc_ssor)
+            stats.ssor_param = ssor_param;
+
+        try {
+            if (pc_ssor && mixed_precision != MixedPrecisionCG::off) {
+                mixed_precision_cg_heat.initialize(system_matrix_heat, ssor_param);
+                stats.iterations = mixed_precision_cg_heat.solve(mixed_precision,
+                        system_matrix_heat, solution_heat, system_rhs_heat, max_iter, tol);
+                stats.residual_history = mixed_precision_cg_heat.get_residual_history();
+                if (!stats.residual_history.empty())
+                    stats.residual = stats.residual_history.back();
+            } else {
+                if (pc_ssor) {
+                    preconditioner_ssor.initialize(system_matrix_heat, ssor_param);
+                    solver_cg.solve(system_matrix_heat, solution_heat, system_rhs_heat, preconditioner_ssor);
+                } else {
+                    solver_cg.solve(system_matrix_heat, solution_heat, system_rhs_heat, PreconditionIdentity());
+                }
+                solver_control.fill(stats);
+            }
+        } catch (SolverControl::NoConvergence &) {
+            if (tune)
+                ssor_tuner_heat.add_result(max_iter);
+            throw;
+        }
+        if (tune)
+            ssor_tuner_heat.add_result(stats.iterations);
+
+        heat_constraints.distribute(solution_heat);
     }
 
     old_solution_heat = solution_heat;
-    return solver_control.last_step();
+    if (tracer) {
+        tracer->counter("hcg", stats.iterations);
+        tracer->counter("hcg_residual", stats.residual);
+        if (stats.ssor_param > 0.0)
+            tracer->counter("hcg_ssor_param", stats.ssor_param);
+    }
+    stats.wall_time = timer.wall_time();
+    return stats;
 }
 
+template<int dim>
+StepStats CurrentsAndHeating<dim>::do_time_step(const bool euler_implicit, int max_iter, double tol,
+        bool pc_ssor, double ssor_param) {
+    TraceRecorder::Scope trace(tracer, "time_step");
+    Timer step_timer, timer;
+    StepStats stats;
+
+    assemble_current_system();
+    stats.assemble_current_time = timer.wall_time();
+    stats.current = solve_current(max_iter, tol, pc_ssor, ssor_param);
+
+    timer.restart();
+    if (euler_implicit)
+        assemble_heating_system_euler_implicit();
+    else
+        assemble_heating_system_crank_nicolson();
+    stats.assemble_heat_time = timer.wall_time();
+    stats.heat = solve_heat(max_iter, tol, pc_ssor, ssor_param);
+
+    stats.peak_temperature = get_max_temperature();
+    stats.wall_time = step_timer.wall_time();
+
+    // the later steps reuse the workspaces of the first one, so its peak memory is enough
+    ++n_time_steps;
+    if (n_time_steps == 1)
+        memory_report.record_phase("time_step");
+    if (progress_callback)
+        progress_callback(n_time_steps, stats);
+    return stats;
+}
+
+template<int dim>
+std::vector<StepStats> CurrentsAndHeating<dim>::do_time_steps(const unsigned int n_steps,
+        const bool euler_implicit_first, int max_iter, double tol, bool pc_ssor, double ssor_param) {
+    std::vector<StepStats> stats;
+    stats.reserve(n_steps);
+    for (unsigned int i = 0; i < n_steps; ++i) {
+        if (cancellation && cancellation->is_cancelled())
+            break;
+        stats.push_back(do_time_step(euler_implicit_first && i == 0, max_iter, tol, pc_ssor, ssor_param));
+    }
+    memory_report.record_phase("time_steps");
+    return stats;
+}
+
+template<int dim>
+std::future<StepStats> CurrentsAndHeating<dim>::do_time_step_async(const bool euler_implicit, int max_iter,
+        double tol, bool pc_ssor, double ssor_param) {
+    return worker.submit([=]() {
+        return do_time_step(euler_implicit, max_iter, tol, pc_ssor, ssor_param);
+    });
+}
+
+template<int dim>
+std::future<std::vector<StepStats> > CurrentsAndHeating<dim>::do_time_steps_async(const unsigned int n_steps,
+        const bool euler_implicit_first, int max_iter, double tol, bool pc_ssor, double ssor_param) {
+    return worker.submit([=]() {
+        return do_time_steps(n_steps, euler_implicit_first, max_iter, tol, pc_ssor, ssor_param);
+    });
+}
+
+template<int dim>
+void CurrentsAndHeating<dim>::set_progress_callback(StepProgress callback) {
+    progress_callback = callback;
+}
+
+template<int dim>
+void CurrentsAndHeating<dim>::set_cancellation_token(const CancellationToken *token) {
+    cancellation = token;
+}
 
 template<int dim>
 void CurrentsAndHeating<dim>::set_physical_quantities(PhysicalQuantities *pq_) {
     pq = pq_;
 }
 
+template<int dim>
+void CurrentsAndHeating<dim>::set_ssor_autotuning(const bool enable) {
+    ssor_autotuning = enable;
+    ssor_tuner_current.restart();
+    ssor_tuner_heat.restart();
+}
+
+template<int dim>
+void CurrentsAndHeating<dim>::set_trace_recorder(TraceRecorder *recorder) {
+    tracer = recorder;
+}
+
+template<int dim>
+void CurrentsAndHeating<dim>::set_mixed_precision(const MixedPrecisionCG::Mode mode) {
+    mixed_precision = mode;
+}
+
+template<int dim>
+void CurrentsAndHeating<dim>::set_matrix_free_heating(const bool enable) {
+    matrix_free_heating = enable;
+}
+
 template<int dim>
 void CurrentsAndHeating<dim>::set_timestep(const double time_step_) {
     time_step = time_step_;
@@ -551,6 +780,7 @@ void CurrentsAndHeating<dim>::set_electric_field_bc(const Laplace<dim> &laplace)
     double eps = 1e-9;
 
     interface_map_field.clear();
+    efield_array = NULL;
 
     // ---------------------------------------------------------------------------------------------
     // Loop over vacuum interface cells
@@ -615,6 +845,7 @@ template<int dim>
 void CurrentsAndHeating<dim>::set_electric_field_bc(const std::vector<double>& elfields) {
     const unsigned n_faces_per_cell = GeometryInfo<dim>::faces_per_cell;
     interface_map_field.clear();
+    efield_array = NULL;
 
     // Loop over copper interface cells
     typename DoFHandler<dim>::active_cell_iterator cell;
@@ -628,6 +859,12 @@ void CurrentsAndHeating<dim>::set_electric_field_bc(const std::vector<double>& e
             }
 }
 
+template<int dim>
+void CurrentsAndHeating<dim>::set_electric_field_bc(const double *elfields) {
+    interface_map_field.clear();
+    efield_array = elfields;
+}
+
 template<int dim>
 void CurrentsAndHeating<dim>::set_electric_field_bc(const double uniform_efield) {
     uniform_efield_bc = uniform_efield;
@@ -639,6 +876,7 @@ void CurrentsAndHeating<dim>::set_emission_bc(const std::vector<double> &emissio
     const unsigned n_faces_per_cell = GeometryInfo<dim>::faces_per_cell;
     interface_map_emission_current.clear();
     interface_map_nottingham.clear();
+    emission_current_array = nottingham_array = NULL;
 
     // Loop over copper interface cells
     typename DoFHandler<dim>::active_cell_iterator cell;
@@ -654,6 +892,15 @@ void CurrentsAndHeating<dim>::set_emission_bc(const std::vector<double> &emissio
             }
 }
 
+template<int dim>
+void CurrentsAndHeating<dim>::set_emission_bc(const double *emission_currents,
+        const double *nottingham_heats) {
+    interface_map_emission_current.clear();
+    interface_map_nottingham.clear();
+    emission_current_array = emission_currents;
+    nottingham_array = nottingham_heats;
+}
+
 template<int dim>
 std::vector<double> CurrentsAndHeating<dim>::get_temperature(const std::vector<int> &cell_indexes,
         const std::vector<int> &vert_indexes) {
@@ -716,8 +963,29 @@ void CurrentsAndHeating<dim>::get_surface_nodes(std::vector<Point<dim>>& nodes)
                 nodes.push_back(cell->face(f)->center());
 }
 
+template<int dim>
+void CurrentsAndHeating<dim>::get_surface_temperatures(double *temperatures) const {
+    const unsigned n_faces_per_cell = GeometryInfo<dim>::faces_per_cell;
+    const unsigned n_vertices_per_face = GeometryInfo<dim>::vertices_per_face;
+
+    // Loop over copper interface cells; the heat dofs are on the same mesh as the current ones
+    typename DoFHandler<dim>::active_cell_iterator cell;
+    unsigned i = 0;
+    for (cell = dof_handler_heat.begin_active(); cell != dof_handler_heat.end(); ++cell)
+        for (unsigned f = 0; f < n_faces_per_cell; ++f)
+            if (cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
+                double temperature = 0.0;
+                for (unsigned v = 0; v < n_vertices_per_face; ++v)
+                    temperature += solution_heat[cell->face(f)->vertex_dof_index(v, 0)];
+                temperatures[i++] = temperature / n_vertices_per_face;
+            }
+}
+
 template<int dim>
 double CurrentsAndHeating<dim>::get_efield_bc(const std::pair<unsigned, unsigned> cop_cell_info) {
+    if (efield_array)
+        return efield_array[surface_face_index.at(cop_cell_info)];
+
     double e_field = 1.0;
     if (interface_map_field.empty()) {
         e_field = uniform_efield_bc;
@@ -731,6 +999,9 @@ double CurrentsAndHeating<dim>::get_efield_bc(const std::pair<unsigned, unsigned
 template<int dim>
 double CurrentsAndHeating<dim>::get_emission_current_bc(const std::pair<unsigned, unsigned> cop_cell_info,
         const double temperature) {
+    if (emission_current_array)
+        return emission_current_array[surface_face_index.at(cop_cell_info)];
+
     double emission_current = 0.0;
     if (interface_map_emission_current.empty()) {
         double e_field = get_efield_bc(cop_cell_info);
@@ -745,6 +1016,9 @@ double CurrentsAndHeating<dim>::get_emission_current_bc(const std::pair<unsigned
 template<int dim>
 double CurrentsAndHeating<dim>::get_nottingham_heat_bc(const std::pair<unsigned, unsigned> cop_cell_info,
         const double temperature) {
+    if (nottingham_array)
+        return nottingham_array[surface_face_index.at(cop_cell_info)];
+
     double nottingham_heat = 0.0;
     if (interface_map_nottingham.empty()) {
         double e_field = get_efield_bc(cop_cell_info);
@@ -777,6 +1051,33 @@ double CurrentsAndHeating<dim>::probe_temperature(const Point<dim> &p) const {
     return VectorTools::point_value(dof_handler_heat, solution_heat, p);
 }
 
+template<int dim>
+MemoryReport CurrentsAndHeating<dim>::get_memory_report() const {
+    MemoryReport report = memory_report;
+    report.set_item("triangulation", triangulation.memory_consumption());
+    report.set_item("dof_handlers", dof_handler_current.memory_consumption()
+            + dof_handler_heat.memory_consumption());
+    report.set_item("constraints", current_constraints.memory_consumption()
+            + heat_constraints.memory_consumption());
+    report.set_item("sparsity_patterns", sparsity_pattern_current.memory_consumption()
+            + sparsity_pattern_heat.memory_consumption());
+    report.set_item("matrices", system_matrix_current.memory_consumption()
+            + system_matrix_heat.memory_consumption());
+    report.set_item("vectors", solution_current.memory_consumption()
+            + old_solution_current.memory_consumption() + system_rhs_current.memory_consumption()
+            + solution_heat.memory_consumption() + old_solution_heat.memory_consumption()
+            + system_rhs_heat.memory_consumption() + heat_lift.memory_consumption());
+    report.set_item("heat_operator", heat_operator.memory_consumption());
+    report.set_item("solver_workspace", mixed_precision_cg_current.memory_consumption()
+            + mixed_precision_cg_heat.memory_consumption());
+    report.set_item("interface_maps", (interface_map_field.size() + interface_map_emission_current.size()
+            + interface_map_nottingham.size() + surface_face_index.size())
+            * (sizeof(std::pair<unsigned, unsigned>) + sizeof(double)));
+    if (pq)
+        report.set_item("physical_quantities", pq->memory_consumption());
+    return report;
+}
+
 // ----------------------------------------------------------------------------------------
 // Class for outputting the resulting field distribution (calculated from potential distr.)
 template <int dim>
@@ -823,6 +1124,7 @@ public:
 
 template<int dim>
 void CurrentsAndHeating<dim>::output_results_current(const std::string filename) const {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::output_results_current");
 
     FieldPostProcessor<dim> field_post_processor; // needs to be before data_out
     DataOut<dim> data_out;
@@ -840,10 +1142,13 @@ void CurrentsAndHeating<dim>::output_results_current(const std::string filename)
         std::cerr << "WARNING: Couldn't open " + filename << ". ";
         std::cerr << "Output is not saved." << std::endl;
     }
+
+    memory_report.record_phase("output_current");
 }
 
 template<int dim>
 void CurrentsAndHeating<dim>::output_results_heating(const std::string filename) const {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeating::output_results_heating");
 
     SigmaPostProcessor<dim> sigma_post_processor(pq);
     DataOut<dim> data_out;
@@ -861,6 +1166,8 @@ void CurrentsAndHeating<dim>::output_results_heating(const std::string filename)
         std::cerr << "WARNING: Couldn't open " + filename << ". ";
         std::cerr << "Output is not saved." << std::endl;
     }
+
+    memory_report.record_phase("output_heating");
 }
 
 template class CurrentsAndHeating<2> ;
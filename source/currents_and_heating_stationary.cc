@@ -22,6 +22,7 @@
 #include <deal.II/base/function.h>
 #include <deal.II/base/logstream.h>
 #include <deal.II/base/timer.h>
+#include <deal.II/base/vectorization.h>
 
 #include <deal.II/numerics/vector_tools.h>
 #include <deal.II/numerics/matrix_tools.h>
@@ -38,6 +39,7 @@
 #include <cassert>
 #include <algorithm>
 
+#include "sparsity_builder.h"
 #include "utility.h"
 
 namespace fch {
@@ -47,16 +49,26 @@ template<int dim>
 CurrentsAndHeatingStationary<dim>::CurrentsAndHeatingStationary() :
         ambient_temperature(ambient_temperature_default), fe(FE_Q<dim>(currents_degree), 1, // Finite element type (1) = linear, etc and number of components
                 FE_Q<dim>(heating_degree), 1), // (we have 2 variables: potential and T with 1 component each)
-        dof_handler(triangulation), pq(NULL), laplace(NULL), previous_iteration(
-        NULL), interp_initial_conditions(false) {
+        dof_handler(triangulation), jacobian_factorized(false), factor_memory(0),
+        jacobian_reuse(false),
+        max_contraction_rate(0.5), batched_assembly(false), n_newton_iterations(0),
+        warm_start(false), warm_solution_valid(false),
+        reassembly_temperature_tolerance(-1.0),
+        reassembly_potential_tolerance(1e-3), pq(NULL), laplace(NULL), tracer(NULL), efield_array(NULL), previous_iteration(
+        NULL), interp_initial_conditions(false), cancellation(NULL) {
 }
 
 template<int dim>
 CurrentsAndHeatingStationary<dim>::CurrentsAndHeatingStationary(PhysicalQuantities *pq_, Laplace<dim>* laplace_) :
         ambient_temperature(ambient_temperature_default), fe(FE_Q<dim>(currents_degree), 1, // Finite element type (1) = linear, etc and number of components
                 FE_Q<dim>(heating_degree), 1), // (we have 2 variables: potential and T with 1 component each)
-        dof_handler(triangulation), pq(pq_), laplace(laplace_), previous_iteration(
-        NULL), interp_initial_conditions(false) {
+        dof_handler(triangulation), jacobian_factorized(false), factor_memory(0),
+        jacobian_reuse(false),
+        max_contraction_rate(0.5), batched_assembly(false), n_newton_iterations(0),
+        warm_start(false), warm_solution_valid(false),
+        reassembly_temperature_tolerance(-1.0),
+        reassembly_potential_tolerance(1e-3), pq(pq_), laplace(laplace_), tracer(NULL), efield_array(NULL), previous_iteration(
+        NULL), interp_initial_conditions(false), cancellation(NULL) {
 }
 
 template<int dim>
@@ -64,8 +76,14 @@ CurrentsAndHeatingStationary<dim>::CurrentsAndHeatingStationary(PhysicalQuantiti
         CurrentsAndHeatingStationary *ch_previous_iteration_) :
         ambient_temperature(ambient_temperature_default), fe(FE_Q<dim>(currents_degree), 1, // Finite element type (1) = linear, etc and number of components
                 FE_Q<dim>(heating_degree), 1), // (we have 2 variables: potential and T with 1 component each)
-        dof_handler(triangulation), pq(pq_), laplace(laplace_), previous_iteration(
-                ch_previous_iteration_), interp_initial_conditions(ch_previous_iteration_ != NULL) {
+        dof_handler(triangulation), jacobian_factorized(false), factor_memory(0),
+        jacobian_reuse(false),
+        max_contraction_rate(0.5), batched_assembly(false), n_newton_iterations(0),
+        warm_start(false), warm_solution_valid(false),
+        reassembly_temperature_tolerance(-1.0),
+        reassembly_potential_tolerance(1e-3), pq(pq_), laplace(laplace_), tracer(NULL), efield_array(NULL), previous_iteration(
+                ch_previous_iteration_), interp_initial_conditions(ch_previous_iteration_ != NULL),
+        cancellation(NULL) {
 }
 
 template<int dim>
@@ -80,6 +98,9 @@ void CurrentsAndHeatingStationary<dim>::reinitialize(Laplace<dim>* laplace_,
     triangulation.clear();
     interface_map.clear();
     interface_map_field.clear();
+    surface_face_index.clear();
+    efield_array = NULL;
+    warm_solution_valid = false;
 
     laplace = laplace_;
     previous_iteration = ch_previous_iteration_;
@@ -95,11 +116,52 @@ void CurrentsAndHeatingStationary<dim>::set_physical_quantities(PhysicalQuantiti
     pq = pq_;
 }
 
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_jacobian_reuse(bool enable, double max_contraction_rate_) {
+    jacobian_reuse = enable;
+    max_contraction_rate = max_contraction_rate_;
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_partial_reassembly(double temperature_tolerance,
+        double potential_rel_tolerance) {
+    reassembly_temperature_tolerance = temperature_tolerance;
+    reassembly_potential_tolerance = potential_rel_tolerance;
+    invalidate_cell_cache();
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_trace_recorder(TraceRecorder *recorder) {
+    tracer = recorder;
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_batched_assembly(bool enable) {
+    batched_assembly = enable;
+}
+
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::set_ambient_temperature(double ambient_temperature_) {
+    if (ambient_temperature_ != ambient_temperature)
+        warm_solution_valid = false;
     ambient_temperature = ambient_temperature_;
 }
 
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_warm_start(bool enable) {
+    warm_start = enable;
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_progress_callback(NewtonProgress callback) {
+    progress_callback = callback;
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_cancellation_token(const CancellationToken *token) {
+    cancellation = token;
+}
+
 template<int dim>
 Triangulation<dim>* CurrentsAndHeatingStationary<dim>::get_triangulation() {
     return &triangulation;
@@ -115,6 +177,53 @@ Vector<double>* CurrentsAndHeatingStationary<dim>::get_solution() {
     return &present_solution;
 }
 
+template<int dim>
+double CurrentsAndHeatingStationary<dim>::get_max_temperature() const {
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+    double max_temperature = 0.0;
+    typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc = dof_handler.end();
+    for (; cell != endc; ++cell) {
+        cell->get_dof_indices(local_dof_indices);
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+            if (fe.system_to_component_index(i).first == 1)
+                max_temperature = std::max(max_temperature, present_solution(local_dof_indices[i]));
+    }
+    return max_temperature;
+}
+
+template<int dim>
+double CurrentsAndHeatingStationary<dim>::get_total_current() const {
+    // same face quadrature as in the Newton assembly
+    QGauss<dim - 1> face_quadrature_formula(
+            std::max(std::max(currents_degree, heating_degree), Laplace<dim>::shape_degree) + 1);
+    FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula, update_values | update_JxW_values);
+
+    const FEValuesExtractors::Scalar temperature(1);
+    std::vector<double> temperature_values(face_quadrature_formula.size());
+
+    double total_current = 0.0;
+    typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc = dof_handler.end();
+    for (; cell != endc; ++cell) {
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f) {
+            if (!cell->face(f)->at_boundary() || cell->face(f)->boundary_id() != BoundaryId::copper_surface)
+                continue;
+
+            double efield;
+            if (!get_efield_bc(std::pair<unsigned, unsigned>(cell->index(), f), efield))
+                continue;
+
+            fe_face_values.reinit(cell, f);
+            fe_face_values[temperature].get_function_values(present_solution, temperature_values);
+            for (unsigned int q = 0; q < face_quadrature_formula.size(); ++q)
+                total_current += pq->emission_current(efield, temperature_values[q])
+                        * fe_face_values.JxW(q);
+        }
+    }
+    return total_current;
+}
+
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::import_mesh_from_file(const std::string file_name) {
     MeshPreparer<dim> mesh_preparer;
@@ -204,25 +313,102 @@ std::vector<Tensor<1, dim> > CurrentsAndHeatingStationary<dim>::get_current(
 
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::setup_system() {
+    TraceRecorder::Scope trace(tracer, "CurrentsAndHeatingStationary::setup_system");
+
     dof_handler.distribute_dofs(fe);
     //std::cout << "Number of degrees of freedom: " << dof_handler.n_dofs()
     //		<< std::endl;
 
     DoFRenumbering::component_wise(dof_handler);
 
-    DynamicSparsityPattern dsp(dof_handler.n_dofs());
-    DoFTools::make_sparsity_pattern(dof_handler, dsp);
-    sparsity_pattern.copy_from(dsp);
+    // Zero potential and temperature updates at the bulk bottom boundary,
+    // as the initial condition already has correct dirichlet BCs
+    newton_constraints.clear();
+    VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_bottom,
+            ZeroFunction<dim>(2), newton_constraints);
+    newton_constraints.close();
+
+    dirichlet_dofs.clear();
+    for (types::global_dof_index i = 0; i < dof_handler.n_dofs(); ++i)
+        if (newton_constraints.is_constrained(i))
+            dirichlet_dofs.push_back(i);
+
+    make_static_sparsity_pattern(dof_handler, newton_constraints, sparsity_pattern);
 
     system_matrix.reinit(sparsity_pattern);
+    jacobian_factorized = false;
+
+    // the cache is allocated on first use for the new mesh
+    cell_cache.clear();
+    assembled_matrix.clear();
+    assembled_rhs.reinit(0);
 
     newton_update.reinit(dof_handler.n_dofs());
     present_solution.reinit(dof_handler.n_dofs());
+    warm_solution_valid = false;
     system_rhs.reinit(dof_handler.n_dofs());
+
+    newton_scratch.reset(new NewtonScratch(fe, std::max(currents_degree, heating_degree) + 1,
+            std::max(std::max(currents_degree, heating_degree), Laplace<dim>::shape_degree) + 1));
+
+    // Position of the surface faces in the externally given field arrays
+    surface_face_index.clear();
+    efield_array = NULL;
+    unsigned int face_index = 0;
+    typename DoFHandler<dim>::active_cell_iterator cell;
+    for (cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f)
+            if (cell->face(f)->boundary_id() == BoundaryId::copper_surface)
+                surface_face_index[std::pair<unsigned, unsigned>(cell->index(), f)] = face_index++;
+
+    memory_report.record_phase("setup");
+}
+
+template<int dim>
+CurrentsAndHeatingStationary<dim>::NewtonScratch::NewtonScratch(const FESystem<dim> &fe,
+        const unsigned int quadrature_points_1d, const unsigned int face_quadrature_points_1d) :
+        quadrature(quadrature_points_1d), face_quadrature(face_quadrature_points_1d),
+        fe_values(fe, quadrature,
+                update_values | update_gradients | update_quadrature_points | update_JxW_values),
+        fe_face_values(fe, face_quadrature,
+                update_values | update_gradients | update_normal_vectors | update_quadrature_points
+                        | update_JxW_values),
+        cell_matrix(fe.dofs_per_cell, fe.dofs_per_cell), cell_rhs(fe.dofs_per_cell),
+        local_dof_indices(fe.dofs_per_cell),
+        potential_gradients(quadrature.size()), temperature_values(quadrature.size()),
+        temperature_gradients(quadrature.size()),
+        potential_phi_grad(fe.dofs_per_cell), temperature_phi(fe.dofs_per_cell),
+        temperature_phi_grad(fe.dofs_per_cell),
+        face(face_quadrature.size(), fe.dofs_per_cell),
+        cell_solution(fe.dofs_per_cell), cell_matrix_difference(fe.dofs_per_cell, fe.dofs_per_cell),
+        cell_rhs_difference(fe.dofs_per_cell) {
+
+    const unsigned int n_q_points = quadrature.size();
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+
+    jxw.resize(n_q_points);
+    sigma.resize(n_q_points);
+    dsigma.resize(n_q_points);
+    kappa.resize(n_q_points);
+    dkappa.resize(n_q_points);
+    prev_pot_grad.resize(n_q_points);
+    prev_temp_grad.resize(n_q_points);
+
+    batch_temperature_phi.resize(n_q_points * dofs_per_cell);
+    batch_potential_phi_grad.resize(n_q_points * dofs_per_cell);
+    batch_temperature_phi_grad.resize(n_q_points * dofs_per_cell);
+
+    batch_matrix.resize(dofs_per_cell * dofs_per_cell);
+    batch_rhs.resize(dofs_per_cell);
+    pot_grad_dot_phi.resize(dofs_per_cell);
+    temp_grad_dot_phi.resize(dofs_per_cell);
+
+    batch_cells.reserve(VectorizedArray<double>::n_array_elements);
 }
 
 template<int dim>
 bool CurrentsAndHeatingStationary<dim>::setup_mapping() {
+    TraceRecorder::Scope trace(tracer, "interface_mapping");
 
     double eps = 1e-9;
 
@@ -280,9 +466,14 @@ bool CurrentsAndHeatingStationary<dim>::setup_mapping() {
 
 template<int dim>
 bool CurrentsAndHeatingStationary<dim>::setup_mapping_field(double smoothing) {
+    TraceRecorder::Scope trace(tracer, "interface_mapping");
 
     double eps = 1e-9;
 
+    // the field of the previous run must not survive in a reused object
+    interface_map_field.clear();
+    efield_array = NULL;
+
     // ---------------------------------------------------------------------------------------------
     // Loop over vacuum interface cells
 
@@ -377,22 +568,79 @@ void CurrentsAndHeatingStationary<dim>::get_surface_nodes(std::vector<Point<dim>
 
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::set_electric_field_bc(const std::vector<double>& elfields) {
+    // assign reuses the capacity, so repeated calls do not allocate
+    efield_values.assign(elfields.begin(), elfields.end());
+    set_electric_field_bc(efield_values.data());
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::set_electric_field_bc(const double *elfields) {
+    efield_array = elfields;
+}
+
+template<int dim>
+bool CurrentsAndHeatingStationary<dim>::get_efield_bc(const std::pair<unsigned, unsigned> &face,
+        double &efield) const {
+    if (efield_array) {
+        std::map<std::pair<unsigned, unsigned>, unsigned>::const_iterator index = surface_face_index.find(face);
+        if (index == surface_face_index.end())
+            return false;
+        efield = efield_array[index->second];
+        return true;
+    }
+
+    std::map<std::pair<unsigned, unsigned>, double>::const_iterator field = interface_map_field.find(face);
+    if (field == interface_map_field.end())
+        return false;
+    efield = field->second;
+    return true;
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::get_surface_values(std::vector<Point<dim>>& nodes,
+        std::vector<double>& fields, std::vector<double>& temperatures) const {
     const unsigned n_faces_per_cell = GeometryInfo<dim>::faces_per_cell;
+    nodes.clear();
+    fields.clear();
 
     // Loop over copper interface cells
     typename DoFHandler<dim>::active_cell_iterator cell;
+    for (cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
+        for (unsigned f = 0; f < n_faces_per_cell; ++f)
+            if (cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
+                nodes.push_back(cell->face(f)->center());
+
+                double efield = 0.0;
+                get_efield_bc(std::pair<unsigned, unsigned>(cell->index(), f), efield);
+                fields.push_back(efield);
+            }
+
+    temperatures.resize(nodes.size());
+    get_surface_temperatures(temperatures.data());
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::get_surface_temperatures(double *temperatures) const {
+    const unsigned n_faces_per_cell = GeometryInfo<dim>::faces_per_cell;
+    const unsigned n_vertices_per_face = GeometryInfo<dim>::vertices_per_face;
+
+    // Loop over copper interface cells; the temperature is the second component
+    typename DoFHandler<dim>::active_cell_iterator cell;
     unsigned i = 0;
     for (cell = dof_handler.begin_active(); cell != dof_handler.end(); ++cell)
         for (unsigned f = 0; f < n_faces_per_cell; ++f)
             if (cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
-                std::pair<unsigned, unsigned> face_info(cell->index(), f);
-                interface_map_field.insert(
-                        std::pair<std::pair<unsigned, unsigned>, double>(face_info, elfields[i++]));
+                double temperature = 0.0;
+                for (unsigned v = 0; v < n_vertices_per_face; ++v)
+                    temperature += present_solution[cell->face(f)->vertex_dof_index(v, 1)];
+                temperatures[i++] = temperature / n_vertices_per_face;
             }
 }
 
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::set_initial_condition_slow() {
+    TraceRecorder::Scope trace(tracer, "initial_condition");
+
     /* To set the initial condition based on previous solution, we need to find the values
      * at present mesh nodes based on the values of the previous mesh nodes. Present mesh
      * nodes can be outside the old mesh. The number of nodes can also be different. One
@@ -478,6 +726,7 @@ void CurrentsAndHeatingStationary<dim>::set_initial_condition_slow() {
 
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::set_initial_condition() {
+    TraceRecorder::Scope trace(tracer, "initial_condition");
 
     /* If the initial condition is not interpolated from another solution,
      * set temperature at ambient temperature and potential at 0
@@ -634,70 +883,104 @@ void CurrentsAndHeatingStationary<dim>::set_initial_condition() {
     }
 }
 
-// Assembles the linear system for one Newton iteration
 template<int dim>
-void CurrentsAndHeatingStationary<dim>::assemble_system_newton() {
+void CurrentsAndHeatingStationary<dim>::invalidate_cell_cache() {
+    for (auto &cache : cell_cache)
+        cache.valid = false;
+    // all the cells will be scattered again from scratch
+    if (assembled_rhs.size() > 0) {
+        assembled_matrix = 0;
+        assembled_rhs = 0;
+    }
+}
 
-    TimerOutput timer(std::cout, TimerOutput::never, TimerOutput::wall_times);
-    timer.enter_section("Pre-assembly");
+template<int dim>
+bool CurrentsAndHeatingStationary<dim>::cell_cache_outdated(const Vector<double> &cached_solution,
+        const Vector<double> &cell_solution) const {
+    // The temperatures in the quadrature points are convex combinations of the nodal ones,
+    // so comparing the nodal values bounds the change in the quadrature points
+    for (unsigned int k = 0; k < cell_solution.size(); ++k) {
+        const double change = std::abs(cell_solution[k] - cached_solution[k]);
+        if (fe.system_to_component_index(k).first == 1) {
+            if (change > reassembly_temperature_tolerance)
+                return true;
+        } else if (change > reassembly_potential_tolerance * std::abs(cached_solution[k])) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    QGauss<dim> quadrature_formula(std::max(currents_degree, heating_degree) + 1);
-    QGauss<dim - 1> face_quadrature_formula(
-            std::max(std::max(currents_degree, heating_degree), laplace->shape_degree) + 1);
+// Assembles the linear system for one Newton iteration
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::assemble_system_newton(bool assemble_matrix) {
+    TraceRecorder::Scope trace(tracer, "assemble");
 
-    FEValues<dim> fe_values(fe, quadrature_formula,
-            update_values | update_gradients | update_quadrature_points | update_JxW_values);
+    if (batched_assembly && reassembly_temperature_tolerance < 0.0) {
+        assemble_system_newton_batched(assemble_matrix);
+        return;
+    }
 
-    FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula,
-            update_values | update_gradients | update_normal_vectors | update_quadrature_points
-                    | update_JxW_values);
+    // ---------------------------------------------------------------------------------------------
+    // The finite element values and buffers are created once in setup_system
+    Assert(newton_scratch, ExcNotInitialized());
+    NewtonScratch &scratch = *newton_scratch;
 
-    // For evaluating E field at the copper surface
-    FEFaceValues<dim> vacuum_fe_face_values(laplace->fe, face_quadrature_formula,
-            update_gradients | update_quadrature_points | update_JxW_values);
+    FEValues<dim> &fe_values = scratch.fe_values;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
 
     const unsigned int dofs_per_cell = fe.dofs_per_cell;
-    const unsigned int n_q_points = quadrature_formula.size();
-    const unsigned int n_face_q_points = face_quadrature_formula.size();
-
-    FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-    Vector<double> cell_rhs(dofs_per_cell);
+    const unsigned int n_q_points = scratch.quadrature.size();
 
-    std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+    FullMatrix<double> &cell_matrix = scratch.cell_matrix;
+    Vector<double> &cell_rhs = scratch.cell_rhs;
 
-    // ---------------------------------------------------------------------------------------------
-    // Declaring variables once at the start (for performance reasons)
+    std::vector<types::global_dof_index> &local_dof_indices = scratch.local_dof_indices;
 
     // The previous solution values in the cell quadrature points
-    std::vector<Tensor<1, dim>> prev_sol_potential_gradients(n_q_points);
-    std::vector<double> prev_sol_temperature_values(n_q_points);
-    std::vector<Tensor<1, dim>> prev_sol_temperature_gradients(n_q_points);
+    std::vector<Tensor<1, dim>> &prev_sol_potential_gradients = scratch.potential_gradients;
+    std::vector<double> &prev_sol_temperature_values = scratch.temperature_values;
+    std::vector<Tensor<1, dim>> &prev_sol_temperature_gradients = scratch.temperature_gradients;
 
-    // The previous solution values in the face quadrature points
-    std::vector<Tensor<1, dim>> prev_sol_face_potential_gradients(n_face_q_points);
-    std::vector<double> prev_sol_face_temperature_values(n_face_q_points);
-    std::vector<Tensor<1, dim>> prev_sol_face_temperature_gradients(n_face_q_points);
+    // The previous solution values and shape functions in the face quadrature points
+    NewtonFaceScratch &face_scratch = scratch.face;
 
     // Shape function values and gradients (arrays for every cell DOF)
-    std::vector<double> potential_phi(dofs_per_cell);
-    std::vector<Tensor<1, dim> > potential_phi_grad(dofs_per_cell);
-    std::vector<double> temperature_phi(dofs_per_cell);
-    std::vector<Tensor<1, dim> > temperature_phi_grad(dofs_per_cell);
-
-    // Electric field values from laplace solver
-    std::vector<Tensor<1, dim> > electric_field_values(n_face_q_points);
+    std::vector<Tensor<1, dim> > &potential_phi_grad = scratch.potential_phi_grad;
+    std::vector<double> &temperature_phi = scratch.temperature_phi;
+    std::vector<Tensor<1, dim> > &temperature_phi_grad = scratch.temperature_phi_grad;
     // ----------------------------------------------------------------------------------------------
 
     const FEValuesExtractors::Scalar potential(0);
     const FEValuesExtractors::Scalar temperature(1);
 
-    timer.exit_section();
-    timer.enter_section("Loop header");
+    // Partial reassembly: the contributions of the cells with (almost) unchanged solution
+    // are kept in assembled_matrix & assembled_rhs and only the changed cells are updated
+    const bool use_cache = assemble_matrix && reassembly_temperature_tolerance >= 0.0;
+    Vector<double> &cell_solution = scratch.cell_solution;
+    FullMatrix<double> &cell_matrix_difference = scratch.cell_matrix_difference;
+    Vector<double> &cell_rhs_difference = scratch.cell_rhs_difference;
+    if (use_cache && cell_cache.size() != triangulation.n_active_cells()) {
+        cell_cache.clear();
+        cell_cache.resize(triangulation.n_active_cells());
+        assembled_matrix.reinit(sparsity_pattern);
+        assembled_rhs.reinit(dof_handler.n_dofs());
+    }
 
     typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc =
             dof_handler.end();
     for (; cell != endc; ++cell) {
 
+        if (use_cache) {
+            cell->get_dof_indices(local_dof_indices);
+            for (unsigned int k = 0; k < dofs_per_cell; ++k)
+                cell_solution[k] = present_solution[local_dof_indices[k]];
+
+            const CellCache &cache = cell_cache[cell->index()];
+            if (cache.valid && !cell_cache_outdated(cache.solution, cell_solution))
+                continue;
+        }
+
         fe_values.reinit(cell);
 
         cell_matrix = 0;
@@ -708,9 +991,6 @@ void CurrentsAndHeatingStationary<dim>::assemble_system_newton() {
         fe_values[temperature].get_function_gradients(present_solution,
                 prev_sol_temperature_gradients);
 
-        timer.exit_section();
-        timer.enter_section("Matrix assembly 1");
-
         // ---------------------------------------------------------------------------------------------
         // Local matrix assembly
         // ---------------------------------------------------------------------------------------------
@@ -731,11 +1011,8 @@ void CurrentsAndHeatingStationary<dim>::assemble_system_newton() {
                 temperature_phi_grad[k] = fe_values[temperature].gradient(k, q);
             }
 
-            timer.exit_section();
-            timer.enter_section("Matrix assembly 2");
-
             for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                for (unsigned int j = 0; j < dofs_per_cell; ++j) {
+                for (unsigned int j = 0; j < dofs_per_cell && assemble_matrix; ++j) {
                     cell_matrix(i, j) += (-(potential_phi_grad[i] * sigma * potential_phi_grad[j])
                             - (potential_phi_grad[i] * dsigma * prev_pot_grad * temperature_phi[j])
                             + (temperature_phi[i] * 2 * sigma * prev_pot_grad
@@ -761,143 +1038,330 @@ void CurrentsAndHeatingStationary<dim>::assemble_system_newton() {
                         - temperature_phi[i] * sigma * prev_pot_grad * prev_pot_grad
                         + temperature_phi_grad[i] * kappa * prev_temp_grad) * fe_values.JxW(q);
             }
-            timer.exit_section();
-            timer.enter_section("Matrix assembly 1");
         }
         // ---------------------------------------------------------------------------------------------
-        timer.exit_section();
-        timer.enter_section("Rhs assembly");
-        // ---------------------------------------------------------------------------------------------
         // Local right-hand side assembly
         // ---------------------------------------------------------------------------------------------
         // integration over the boundary (cell faces)
-        for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f) {
-            if (cell->face(f)->at_boundary()) {
-
-                if (cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
-                    fe_face_values.reinit(cell, f);
-
-                    fe_face_values[potential].get_function_gradients(present_solution,
-                            prev_sol_face_potential_gradients);
-                    fe_face_values[temperature].get_function_values(present_solution,
-                            prev_sol_face_temperature_values);
-                    fe_face_values[temperature].get_function_gradients(present_solution,
-                            prev_sol_face_temperature_gradients);
-
-                    // ---------------------------------------------------------------------------------------------
-                    // Vacuum side stuff
-                    // find the corresponding vacuum side face to the copper side face
-                    std::pair<unsigned, unsigned> cop_cell_info = std::pair<unsigned, unsigned>(
-                            cell->index(), f);
-                    // check if the corresponding vacuum face exists in our mapping
-                    assert(interface_map_field.count(cop_cell_info) == 1);
-                    /*
-                     std::pair<unsigned, unsigned> vac_cell_info = interface_map[cop_cell_info];
-                     // Using DoFAccessor (groups.google.com/forum/?hl=en-GB#!topic/dealii/azGWeZrIgR0)
-                     typename DoFHandler<dim>::active_cell_iterator vac_cell(&(laplace->triangulation),
-                     0, vac_cell_info.first, &(laplace->dof_handler));
-
-                     vacuum_fe_face_values.reinit(vac_cell, vac_cell_info.second);
-                     vacuum_fe_face_values.get_function_gradients(laplace->solution, electric_field_values);
-                     */
-                    double e_field = interface_map_field[cop_cell_info];
-                    // ---------------------------------------------------------------------------------------------
-
-                    // loop through the quadrature points
-                    for (unsigned int q = 0; q < n_face_q_points; ++q) {
-
-                        double prev_temp = prev_sol_face_temperature_values[q];
-                        const Tensor<1, dim> prev_pot_grad = prev_sol_face_potential_gradients[q];
-                        const Tensor<1, dim> prev_temp_grad = prev_sol_face_temperature_gradients[q];
-
-                        const Tensor<1, dim> normal_vector = fe_face_values.normal_vector(q);
-
-                        double dsigma = pq->dsigma(prev_temp);
-                        double dkappa = pq->dkappa(prev_temp);
-                        //double e_field = electric_field_values[q].norm();
-                        double emission_current = pq->emission_current(e_field, prev_temp);
-                        // Nottingham heat flux in
-                        // (eV*A/nm^2) -> (eV*n*q_e/(s*nm^2)) -> (J*n/(s*nm^2)) -> (W/nm^2)
-                        double nottingham_flux = -1.0 * pq->nottingham_de(e_field, prev_temp)
-                                * emission_current;
-
-                        for (unsigned int k = 0; k < dofs_per_cell; ++k) {
-                            potential_phi[k] = fe_face_values[potential].value(k, q);
-                            temperature_phi[k] = fe_face_values[temperature].value(k, q);
-                        }
-                        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-                            cell_rhs(i) += (-(potential_phi[i] * emission_current)
-                                    - (temperature_phi[i] * nottingham_flux))
-                                    * fe_face_values.JxW(q);
+        assemble_surface_terms_newton(cell, fe_face_values, face_scratch, cell_matrix, cell_rhs,
+                assemble_matrix);
+        // ---------------------------------------------------------------------------------------------
 
-                            /*
-                             std::cout << (potential_phi[i] * sigma * normal_vector * prev_pot_grad) << " "
-                             << (potential_phi[i] * emission_current) << std::endl;
-                             */
-                            for (unsigned int j = 0; j < dofs_per_cell; ++j) {
-                                cell_matrix(i, j) += ((potential_phi[i] * normal_vector * dsigma
-                                        * prev_pot_grad * temperature_phi[j])
-                                        + (temperature_phi[i] * normal_vector * dkappa
-                                                * prev_temp_grad * temperature_phi[j]))
-                                        * fe_face_values.JxW(q);
-                            }
-                        }
+        cell->get_dof_indices(local_dof_indices);
+
+        if (use_cache) {
+            // scatter the difference to the previously scattered contribution of the cell
+            CellCache &cache = cell_cache[cell->index()];
+            if (!cache.valid) {
+                cache.matrix.reinit(dofs_per_cell, dofs_per_cell);
+                cache.rhs.reinit(dofs_per_cell);
+                cache.solution.reinit(dofs_per_cell);
+            }
+            cell_matrix_difference = cell_matrix;
+            cell_matrix_difference.add(-1.0, cache.matrix);
+            cell_rhs_difference = cell_rhs;
+            cell_rhs_difference -= cache.rhs;
+            distribute_local_to_global_newton(cell_matrix_difference, cell_rhs_difference,
+                    local_dof_indices, assembled_matrix, assembled_rhs, true);
+
+            cache.matrix = cell_matrix;
+            cache.rhs = cell_rhs;
+            cache.solution = cell_solution;
+            cache.valid = true;
+        } else {
+            distribute_local_to_global_newton(cell_matrix, cell_rhs, local_dof_indices,
+                    system_matrix, system_rhs, assemble_matrix);
+        }
+    }
+
+    if (use_cache) {
+        system_matrix.copy_from(assembled_matrix);
+        system_rhs = assembled_rhs;
+    }
+
+    apply_newton_dirichlet_bc(assemble_matrix);
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::distribute_local_to_global_newton(
+        const FullMatrix<double> &cell_matrix, const Vector<double> &cell_rhs,
+        const std::vector<types::global_dof_index> &local_dof_indices,
+        SparseMatrix<double> &matrix, Vector<double> &rhs, const bool assemble_matrix) const {
+
+    // The Dirichlet values of the update are zero, so eliminating the constrained
+    // rows and columns needs no rhs correction and keeps the Jacobian structure
+    const unsigned int dofs_per_cell = local_dof_indices.size();
+    for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+        if (newton_constraints.is_constrained(local_dof_indices[i]))
+            continue;
+        for (unsigned int j = 0; j < dofs_per_cell && assemble_matrix; ++j)
+            if (!newton_constraints.is_constrained(local_dof_indices[j]))
+                matrix.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
+
+        rhs(local_dof_indices[i]) += cell_rhs(i);
+    }
+}
+
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::apply_newton_dirichlet_bc(bool assemble_matrix) {
+    // The constrained rows are empty after the assembly; with the direct solver and zero rhs
+    // any nonzero diagonal gives the zero update. When only the residual is assembled,
+    // the factorized Jacobian already has these rows.
+    for (unsigned int k = 0; k < dirichlet_dofs.size(); ++k) {
+        if (assemble_matrix)
+            system_matrix.set(dirichlet_dofs[k], dirichlet_dofs[k], 1.0);
+        system_rhs(dirichlet_dofs[k]) = 0.0;
+    }
+}
+
+// Assembles the linear system for one Newton iteration with the cell volume terms
+// evaluated for VectorizedArray<double>::n_array_elements cells at once
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::assemble_system_newton_batched(bool assemble_matrix) {
+
+    typedef VectorizedArray<double> VA;
+    const unsigned int n_lanes = VA::n_array_elements;
+
+    // The finite element values and buffers are created once in setup_system
+    Assert(newton_scratch, ExcNotInitialized());
+    NewtonScratch &scratch = *newton_scratch;
+
+    FEValues<dim> &fe_values = scratch.fe_values;
+    FEFaceValues<dim> &fe_face_values = scratch.fe_face_values;
+
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    const unsigned int n_q_points = scratch.quadrature.size();
+
+    const FEValuesExtractors::Scalar potential(0);
+    const FEValuesExtractors::Scalar temperature(1);
+
+    // ---------------------------------------------------------------------------------------------
+    // Batch data, every lane holds the values of one cell
+
+    // Coefficients and previous solution in the quadrature points
+    AlignedVector<VA> &jxw = scratch.jxw, &sigma = scratch.sigma, &dsigma = scratch.dsigma,
+            &kappa = scratch.kappa, &dkappa = scratch.dkappa;
+    AlignedVector<Tensor<1, dim, VA> > &prev_pot_grad = scratch.prev_pot_grad,
+            &prev_temp_grad = scratch.prev_temp_grad;
+
+    // Shape functions in [q][k] layout
+    AlignedVector<VA> &temperature_phi = scratch.batch_temperature_phi;
+    AlignedVector<Tensor<1, dim, VA> > &potential_phi_grad = scratch.batch_potential_phi_grad;
+    AlignedVector<Tensor<1, dim, VA> > &temperature_phi_grad = scratch.batch_temperature_phi_grad;
+
+    AlignedVector<VA> &batch_matrix = scratch.batch_matrix;
+    AlignedVector<VA> &batch_rhs = scratch.batch_rhs;
+
+    // Helper vectors for the terms that depend only on i or j
+    AlignedVector<VA> &pot_grad_dot_phi = scratch.pot_grad_dot_phi,
+            &temp_grad_dot_phi = scratch.temp_grad_dot_phi;
+    // ---------------------------------------------------------------------------------------------
+
+    // Scalar data for gathering the lanes, the surface terms and the scatter
+    std::vector<Tensor<1, dim> > &prev_sol_potential_gradients = scratch.potential_gradients;
+    std::vector<double> &prev_sol_temperature_values = scratch.temperature_values;
+    std::vector<Tensor<1, dim> > &prev_sol_temperature_gradients = scratch.temperature_gradients;
+    NewtonFaceScratch &face_scratch = scratch.face;
+
+    FullMatrix<double> &cell_matrix = scratch.cell_matrix;
+    Vector<double> &cell_rhs = scratch.cell_rhs;
+    std::vector<types::global_dof_index> &local_dof_indices = scratch.local_dof_indices;
+
+    std::vector<typename DoFHandler<dim>::active_cell_iterator> &batch_cells = scratch.batch_cells;
+
+    typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc =
+            dof_handler.end();
+    while (cell != endc) {
+        batch_cells.clear();
+        for (; cell != endc && batch_cells.size() < n_lanes; ++cell)
+            batch_cells.push_back(cell);
+
+        // -----------------------------------------------------------------------------------------
+        // Gather the cell data into the lanes; the unused lanes have zero weights
+        for (unsigned int q = 0; q < n_q_points; ++q) {
+            jxw[q] = 0.0;
+            sigma[q] = dsigma[q] = kappa[q] = dkappa[q] = 0.0;
+            for (unsigned int d = 0; d < dim; ++d)
+                prev_pot_grad[q][d] = prev_temp_grad[q][d] = 0.0;
+        }
+
+        for (unsigned int lane = 0; lane < batch_cells.size(); ++lane) {
+            fe_values.reinit(batch_cells[lane]);
+
+            fe_values[potential].get_function_gradients(present_solution,
+                    prev_sol_potential_gradients);
+            fe_values[temperature].get_function_values(present_solution,
+                    prev_sol_temperature_values);
+            fe_values[temperature].get_function_gradients(present_solution,
+                    prev_sol_temperature_gradients);
+
+            for (unsigned int q = 0; q < n_q_points; ++q) {
+                const double prev_temp = prev_sol_temperature_values[q];
+                jxw[q][lane] = fe_values.JxW(q);
+                sigma[q][lane] = pq->sigma(prev_temp);
+                dsigma[q][lane] = pq->dsigma(prev_temp);
+                kappa[q][lane] = pq->kappa(prev_temp);
+                dkappa[q][lane] = pq->dkappa(prev_temp);
+
+                for (unsigned int d = 0; d < dim; ++d) {
+                    prev_pot_grad[q][d][lane] = prev_sol_potential_gradients[q][d];
+                    prev_temp_grad[q][d][lane] = prev_sol_temperature_gradients[q][d];
+                }
+
+                for (unsigned int k = 0; k < dofs_per_cell; ++k) {
+                    const unsigned int qk = q * dofs_per_cell + k;
+                    temperature_phi[qk][lane] = fe_values[temperature].value(k, q);
+                    const Tensor<1, dim> pot_grad = fe_values[potential].gradient(k, q);
+                    const Tensor<1, dim> temp_grad = fe_values[temperature].gradient(k, q);
+                    for (unsigned int d = 0; d < dim; ++d) {
+                        potential_phi_grad[qk][d][lane] = pot_grad[d];
+                        temperature_phi_grad[qk][d][lane] = temp_grad[d];
                     }
                 }
             }
         }
-        // ---------------------------------------------------------------------------------------------
 
-        timer.exit_section();
-        timer.enter_section("Loop footer");
+        // -----------------------------------------------------------------------------------------
+        // Local matrix and rhs assembly for all the lanes at once
+        for (unsigned int k = 0; k < dofs_per_cell * dofs_per_cell; ++k)
+            batch_matrix[k] = 0.0;
+        for (unsigned int k = 0; k < dofs_per_cell; ++k)
+            batch_rhs[k] = 0.0;
 
-        cell->get_dof_indices(local_dof_indices);
+        for (unsigned int q = 0; q < n_q_points; ++q) {
+            const VA pot_grad_squared = prev_pot_grad[q] * prev_pot_grad[q];
+            const Tensor<1, dim, VA> *pg = &potential_phi_grad[q * dofs_per_cell];
+            const Tensor<1, dim, VA> *tg = &temperature_phi_grad[q * dofs_per_cell];
+            const VA *tp = &temperature_phi[q * dofs_per_cell];
 
-        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-            for (unsigned int j = 0; j < dofs_per_cell; ++j)
-                system_matrix.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
+            for (unsigned int k = 0; k < dofs_per_cell; ++k) {
+                pot_grad_dot_phi[k] = prev_pot_grad[q] * pg[k];
+                temp_grad_dot_phi[k] = prev_temp_grad[q] * tg[k];
+            }
 
-            system_rhs(local_dof_indices[i]) += cell_rhs(i);
+            for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+                if (assemble_matrix) {
+                    // The scalar assembler adds the volume terms twice; the factor 2 keeps the batched
+                    // system identical to it (the Newton steps are scaled with sor_alpha accordingly)
+                    const VA wi = 2.0 * jxw[q];
+                    VA *row = &batch_matrix[i * dofs_per_cell];
+                    for (unsigned int j = 0; j < dofs_per_cell; ++j) {
+                        row[j] += (-(sigma[q] * (pg[i] * pg[j]))
+                                - (dsigma[q] * pot_grad_dot_phi[i] * tp[j])
+                                + (2.0 * sigma[q] * tp[i] * pot_grad_dot_phi[j])
+                                + (dsigma[q] * pot_grad_squared * tp[i] * tp[j])
+                                - (dkappa[q] * temp_grad_dot_phi[i] * tp[j])
+                                - (kappa[q] * (tg[i] * tg[j]))) * wi;
+                    }
+                }
+                batch_rhs[i] += (sigma[q] * pot_grad_dot_phi[i]
+                        - sigma[q] * pot_grad_squared * tp[i]
+                        + kappa[q] * temp_grad_dot_phi[i]) * jxw[q];
+            }
         }
-        timer.exit_section();
-        timer.enter_section("Loop header");
-    }
 
-    timer.exit_section();
-    timer.enter_section("Post assembly");
+        // -----------------------------------------------------------------------------------------
+        // Extract the lanes, add the surface terms and scatter
+        for (unsigned int lane = 0; lane < batch_cells.size(); ++lane) {
+            const typename DoFHandler<dim>::active_cell_iterator &batch_cell = batch_cells[lane];
 
-    // Setting Dirichlet boundary values //
+            for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                    cell_matrix(i, j) = batch_matrix[i * dofs_per_cell + j][lane];
+                cell_rhs(i) = batch_rhs[i][lane];
+            }
 
-    // 0 potential at the bulk bottom boundary
-    std::map<types::global_dof_index, double> current_dirichlet;
-    VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_bottom,
-            ZeroFunction<dim>(2), current_dirichlet, fe.component_mask(potential));
+            assemble_surface_terms_newton(batch_cell, fe_face_values, face_scratch, cell_matrix,
+                    cell_rhs, assemble_matrix);
+
+            batch_cell->get_dof_indices(local_dof_indices);
+            distribute_local_to_global_newton(cell_matrix, cell_rhs, local_dof_indices,
+                    system_matrix, system_rhs, assemble_matrix);
+        }
+    }
 
-    MatrixTools::apply_boundary_values(current_dirichlet, system_matrix, newton_update, system_rhs);
+    apply_newton_dirichlet_bc(assemble_matrix);
+}
 
-    // Set 0 temperature BC, as the initial condition already has correct dirichlet BCs
-    std::map<types::global_dof_index, double> temperature_dirichlet;
-    VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_bottom,
-            ZeroFunction<dim>(2), temperature_dirichlet, fe.component_mask(temperature));
+template<int dim>
+void CurrentsAndHeatingStationary<dim>::assemble_surface_terms_newton(
+        const typename DoFHandler<dim>::active_cell_iterator &cell,
+        FEFaceValues<dim> &fe_face_values, NewtonFaceScratch &scratch,
+        FullMatrix<double> &cell_matrix, Vector<double> &cell_rhs, const bool assemble_matrix) {
 
-    /*
-     if (first_iteration) {
-     VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_bottom,
-     ConstantFunction<dim>(ambient_temperature, 2), temperature_dirichlet, fe.component_mask(temperature));
-     } else {
-     VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_bottom,
-     ZeroFunction<dim>(2), temperature_dirichlet, fe.component_mask(temperature));
-     }
-     */
+    const unsigned int dofs_per_cell = fe.dofs_per_cell;
+    const unsigned int n_face_q_points = fe_face_values.n_quadrature_points;
+
+    const FEValuesExtractors::Scalar potential(0);
+    const FEValuesExtractors::Scalar temperature(1);
 
-    MatrixTools::apply_boundary_values(temperature_dirichlet, system_matrix, newton_update,
-            system_rhs);
+    for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f) {
+        if (cell->face(f)->at_boundary()) {
 
-    timer.exit_section();
+            if (cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
+                fe_face_values.reinit(cell, f);
+
+                fe_face_values[potential].get_function_gradients(present_solution,
+                        scratch.potential_gradients);
+                fe_face_values[temperature].get_function_values(present_solution,
+                        scratch.temperature_values);
+                fe_face_values[temperature].get_function_gradients(present_solution,
+                        scratch.temperature_gradients);
+
+                // ---------------------------------------------------------------------------------------------
+                // Vacuum side stuff
+                // find the corresponding vacuum side face to the copper side face
+                std::pair<unsigned, unsigned> cop_cell_info = std::pair<unsigned, unsigned>(
+                        cell->index(), f);
+                // check if the corresponding vacuum face exists in our mapping
+                double e_field = 0.0;
+                const bool field_found = get_efield_bc(cop_cell_info, e_field);
+                assert(field_found);
+                (void) field_found;
+                // ---------------------------------------------------------------------------------------------
+
+                // loop through the quadrature points
+                for (unsigned int q = 0; q < n_face_q_points; ++q) {
+
+                    double prev_temp = scratch.temperature_values[q];
+                    const Tensor<1, dim> prev_pot_grad = scratch.potential_gradients[q];
+                    const Tensor<1, dim> prev_temp_grad = scratch.temperature_gradients[q];
+
+                    const Tensor<1, dim> normal_vector = fe_face_values.normal_vector(q);
+
+                    double dsigma = pq->dsigma(prev_temp);
+                    double dkappa = pq->dkappa(prev_temp);
+                    double emission_current = pq->emission_current(e_field, prev_temp);
+                    // Nottingham heat flux in
+                    // (eV*A/nm^2) -> (eV*n*q_e/(s*nm^2)) -> (J*n/(s*nm^2)) -> (W/nm^2)
+                    double nottingham_flux = -1.0 * pq->nottingham_de(e_field, prev_temp)
+                            * emission_current;
+
+                    for (unsigned int k = 0; k < dofs_per_cell; ++k) {
+                        scratch.potential_phi[k] = fe_face_values[potential].value(k, q);
+                        scratch.temperature_phi[k] = fe_face_values[temperature].value(k, q);
+                    }
+                    for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+                        cell_rhs(i) += (-(scratch.potential_phi[i] * emission_current)
+                                - (scratch.temperature_phi[i] * nottingham_flux))
+                                * fe_face_values.JxW(q);
+
+                        for (unsigned int j = 0; j < dofs_per_cell && assemble_matrix; ++j) {
+                            cell_matrix(i, j) += ((scratch.potential_phi[i] * normal_vector * dsigma
+                                    * prev_pot_grad * scratch.temperature_phi[j])
+                                    + (scratch.temperature_phi[i] * normal_vector * dkappa
+                                            * prev_temp_grad * scratch.temperature_phi[j]))
+                                    * fe_face_values.JxW(q);
+                        }
+                    }
+                }
+            }
+        }
+    }
 }
 
 template<int dim>
-void CurrentsAndHeatingStationary<dim>::solve() {
+void CurrentsAndHeatingStationary<dim>::solve(bool refactorize) {
     // CG doesn't work as the matrix is not symmetric
 
     // GMRES
@@ -909,21 +1373,33 @@ void CurrentsAndHeatingStationary<dim>::solve() {
      */
 
     // UMFPACK solver
-    deallog << "Solving linear system with UMFPACK... " << std::endl;
-    SparseDirectUMFPACK A_direct;
-    A_direct.initialize(system_matrix);
+    // The factorization is kept, so that it can be reused in modified Newton iterations
+    if (refactorize || !jacobian_factorized) {
+        TraceRecorder::Scope trace(tracer, "factorize");
+
+        // UMFPACK does not report the size of its factors; take the memory the factorization added
+        A_direct.clear();
+        const std::size_t rss_before = MemoryReport::current_rss();
+        A_direct.initialize(system_matrix);
+        const std::size_t rss_after = MemoryReport::current_rss();
+        factor_memory = rss_after > rss_before ? rss_after - rss_before : 0;
+        jacobian_factorized = true;
+    }
+
+    TraceRecorder::Scope trace(tracer, "back_substitution");
     A_direct.vmult(newton_update, system_rhs);
 }
 
 template<int dim>
-void CurrentsAndHeatingStationary<dim>::run() {
+NewtonStats CurrentsAndHeatingStationary<dim>::run() {
 
     std::cout << "/---------------------------------------------------------------/" << std::endl
             << "CurrentsAndHeating run():" << std::endl;
 
     double temperature_tolerance = 1.0;
 
-    Timer timer;
+    Timer timer, run_timer;
+    NewtonStats stats;
 
     setup_system();
     setup_mapping_field();
@@ -942,8 +1418,8 @@ void CurrentsAndHeatingStationary<dim>::run() {
 
         timer.restart();
         // reset the state of the linear system
-        system_matrix.reinit(sparsity_pattern);
-        system_rhs.reinit(dof_handler.n_dofs());
+        system_matrix = 0;
+        system_rhs = 0;
         std::cout << "    Reset state: " << timer.wall_time() << " s" << std::endl;
         timer.restart();
 
@@ -956,6 +1432,12 @@ void CurrentsAndHeatingStationary<dim>::run() {
         solve();
         present_solution.add(2.0, newton_update); // alpha = 1.0
 
+        stats.iterations = iteration + 1;
+        stats.n_factorizations++;
+        stats.temperature_error = newton_update.linfty_norm();
+        stats.temperature_error_history.push_back(stats.temperature_error);
+        stats.residual_history.push_back(system_rhs.l2_norm());
+
         std::cout << "    Solver: " << timer.wall_time() << " s" << std::endl;
         timer.restart();
 
@@ -970,29 +1452,41 @@ void CurrentsAndHeatingStationary<dim>::run() {
         if (newton_update.linfty_norm() < temperature_tolerance) {
             std::cout << "    Maximum temperature change less than tolerance: converged!"
                     << std::endl;
+            stats.converged = true;
             break;
         }
     }
     std::cout << "/---------------------------------------------------------------/" << std::endl;
+
+    stats.peak_temperature = get_max_temperature();
+    stats.wall_time = run_timer.wall_time();
+    memory_report.record_phase("newton");
+    return stats;
 }
 
 template<int dim>
-double CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolerance, int max_newton_iter,
+NewtonStats CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolerance, int max_newton_iter,
         bool file_output, std::string out_fname, bool print, double sor_alpha,
         double ic_interp_treshold, bool skip_field_mapping) {
 
+    NewtonStats stats;
+
     if (pq == NULL || laplace == NULL
             || (interp_initial_conditions && previous_iteration == NULL)) {
         std::cerr << "Error: pointer uninitialized! Exiting temperature calculation..."
                 << std::endl;
-        return -1.0;
+        return stats;
     }
     if ((laplace->solution).size() == 0) {
         std::cerr << "Error: Laplace solution hasn't been calculation." << std::endl;
-        return -1.0;
+        return stats;
     }
 
-    if (interp_initial_conditions) {
+    const bool warm = warm_start && warm_solution_valid;
+    if (warm) {
+        if (print)
+            std::cout << "        Continuing from the previous solution" << std::endl;
+    } else if (interp_initial_conditions) {
         double prev_max_temp = (previous_iteration->present_solution).linfty_norm();
         if (prev_max_temp > ic_interp_treshold) {
             if (print)
@@ -1007,7 +1501,7 @@ double CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolera
     } else if (print)
         std::cout << "        Using default initial conditions" << std::endl;
 
-    Timer timer;
+    Timer timer, run_timer;
 
     if (!skip_field_mapping) {
         if (!setup_mapping_field()) {
@@ -1015,51 +1509,85 @@ double CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolera
                     << "Error: Couldn't make a correct mapping between copper and vacuum faces on the interface."
                     << "Make sure that the face elements have one-to-one correspondence there."
                     << std::endl;
-            return -1.0;
+            return stats;
         }
     }
 
-    if (print) {
-        printf("        Mapping setup done, time: %.2f\n", timer.wall_time());
-        timer.restart();
-    }
+    stats.mapping_time = timer.wall_time();
+    timer.restart();
+    if (print)
+        printf("        Mapping setup done, time: %.2f\n", stats.mapping_time);
 
     // Sets the initial state
     // Dirichlet BCs need to hold for this state
     // and 0 dirichlet BC should be applied for all Newton iterations
-    set_initial_condition();
+    if (!warm)
+        set_initial_condition();
+    warm_solution_valid = false;
 
-    if (print) {
-        printf("        Initial condition setup, time: %.2f\n", timer.wall_time());
-        timer.restart();
-    }
+    stats.initial_condition_time = timer.wall_time();
+    timer.restart();
+    if (print)
+        printf("        Initial condition setup, time: %.2f\n", stats.initial_condition_time);
 
     // Output initial condition
     if (file_output) {
         output_results(out_fname, 0);
-        if (print) {
-            printf("        Output initial condition, time: %.2f\n", timer.wall_time());
-            timer.restart();
-        }
+        const double output_time = timer.wall_time();
+        timer.restart();
+        stats.output_time += output_time;
+        if (print)
+            printf("        Output initial condition, time: %.2f\n", output_time);
     }
 
+    // The cached local systems are only reused within the Newton iterations of one run,
+    // as the boundary conditions may have changed in between
+    invalidate_cell_cache();
+
     double temperature_error = 1e15;
+    n_newton_iterations = 0;
+    stats.temperature_error_history.reserve(std::max(max_newton_iter, 0));
+    stats.residual_history.reserve(std::max(max_newton_iter, 0));
+
+    // Jacobian reuse state: the first iteration always takes a fresh Jacobian
+    bool fresh_jacobian = true;
+    double prev_update_norm = -1.0;
 
     // Newton iterations
     for (int iteration = 1; iteration < max_newton_iter + 1; ++iteration) {
+        if (cancellation && cancellation->is_cancelled()) {
+            stats.cancelled = true;
+            if (print)
+                std::cout << "        Cancelled before iteration " << iteration << std::endl;
+            break;
+        }
 
-        system_matrix.reinit(sparsity_pattern);
-        system_rhs.reinit(dof_handler.n_dofs());
+        TraceRecorder::Scope trace(tracer, "newton_iteration");
+
+        const bool full_iteration = !jacobian_reuse || fresh_jacobian || !jacobian_factorized;
+        n_newton_iterations = iteration;
+
+        // reset the state of the linear system in place
+        if (full_iteration)
+            system_matrix = 0;
+        system_rhs = 0;
 
         // Set dirichlet BSs as 0, as they're already set in  the initial condition
-        assemble_system_newton();
+        assemble_system_newton(full_iteration);
         double assemble_time = timer.wall_time();
         timer.restart();
+        stats.assemble_time += assemble_time;
 
-        solve();
+        {
+            TraceRecorder::Scope solve_trace(tracer, "solve");
+            solve(full_iteration);
+        }
         present_solution.add(sor_alpha, newton_update);
         double solution_time = timer.wall_time();
         timer.restart();
+        stats.solve_time += solution_time;
+        if (full_iteration)
+            stats.n_factorizations++;
 
         double max_temp = present_solution.linfty_norm();
         if (max_temp > temperature_stopping_condition) {
@@ -1074,6 +1602,7 @@ double CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolera
             output_results(out_fname, iteration);
         double output_time = timer.wall_time();
         timer.restart();
+        stats.output_time += output_time;
 
         temperature_error = newton_update.linfty_norm();
 
@@ -1083,17 +1612,62 @@ double CurrentsAndHeatingStationary<dim>::run_specific(double temperature_tolera
             if (local_rel_error > potential_rel_error) potential_rel_error = local_rel_error;
         }
 
+        // Take a fresh Jacobian when the chord iterations stop contracting fast enough
+        if (jacobian_reuse) {
+            double update_norm = newton_update.l2_norm();
+            fresh_jacobian = prev_update_norm > 0.0
+                    && update_norm > max_contraction_rate * prev_update_norm;
+            prev_update_norm = update_norm;
+        }
+
+        const double residual = system_rhs.l2_norm();
+        stats.iterations = iteration;
+        stats.temperature_error = temperature_error;
+        stats.potential_rel_error = potential_rel_error;
+        stats.temperature_error_history.push_back(temperature_error);
+        stats.residual_history.push_back(residual);
+
+        if (tracer) {
+            tracer->counter("newton_temperature_error", temperature_error);
+            tracer->counter("newton_potential_rel_error", potential_rel_error);
+            tracer->counter("newton_residual", residual);
+        }
+
         if (print) {
             printf("        iter: %2d; t_error: %7.3f; p_rel_err: %2.0e; assemble_time: %5.2f;"
-                   " sol_time: %5.2f; outp_time: %5.2f\n",
-                   iteration, temperature_error, potential_rel_error, assemble_time, solution_time, output_time);
+                   " sol_time: %5.2f; outp_time: %5.2f%s\n",
+                   iteration, temperature_error, potential_rel_error, assemble_time, solution_time, output_time,
+                   jacobian_reuse ? (full_iteration ? "; jacobian: new" : "; jacobian: reused") : "");
         }
 
-        if (temperature_error < temperature_tolerance && potential_rel_error < 0.5) {
+        if (temperature_error < temperature_tolerance && potential_rel_error < 0.5)
+            stats.converged = true;
+
+        if (progress_callback)
+            progress_callback(stats);
+
+        if (stats.converged)
             break;
-        }
     }
-    return temperature_error;
+
+    // also covers the runs stopped by the temperature limit
+    stats.iterations = n_newton_iterations;
+    stats.temperature_error = temperature_error;
+    stats.peak_temperature = present_solution.size() > 0 ? get_max_temperature() : 0.0;
+    stats.wall_time = run_timer.wall_time();
+    warm_solution_valid = stats.converged;
+    memory_report.record_phase("newton");
+    return stats;
+}
+
+template<int dim>
+std::future<NewtonStats> CurrentsAndHeatingStationary<dim>::run_specific_async(double temperature_tolerance,
+        int max_newton_iter, bool file_output, std::string out_fname, bool print, double sor_alpha,
+        double ic_interp_treshold, bool skip_field_mapping) {
+    return worker.submit([=]() {
+        return run_specific(temperature_tolerance, max_newton_iter, file_output, out_fname, print,
+                sor_alpha, ic_interp_treshold, skip_field_mapping);
+    });
 }
 
 // ----------------------------------------------------------------------------------------
@@ -1150,6 +1724,8 @@ public:
 template<int dim>
 void CurrentsAndHeatingStationary<dim>::output_results(const std::string file_name,
         const int iteration) const {
+    TraceRecorder::Scope trace(tracer, "output");
+
     std::string file_name_mod = file_name;
 
     if (iteration >= 0) {
@@ -1181,6 +1757,36 @@ void CurrentsAndHeatingStationary<dim>::output_results(const std::string file_na
         std::cerr << "WARNING: Couldn't open " + file_name_mod << ". ";
         std::cerr << "Output is not saved." << std::endl;
     }
+
+    memory_report.record_phase("output");
+}
+
+template<int dim>
+MemoryReport CurrentsAndHeatingStationary<dim>::get_memory_report() const {
+    MemoryReport report = memory_report;
+    report.set_item("triangulation", triangulation.memory_consumption());
+    report.set_item("dof_handler", dof_handler.memory_consumption());
+    report.set_item("constraints", newton_constraints.memory_consumption()
+            + dirichlet_dofs.capacity() * sizeof(types::global_dof_index));
+    report.set_item("sparsity_pattern", sparsity_pattern.memory_consumption());
+    report.set_item("matrices", system_matrix.memory_consumption() + assembled_matrix.memory_consumption());
+    report.set_item("vectors", present_solution.memory_consumption() + newton_update.memory_consumption()
+            + system_rhs.memory_consumption() + assembled_rhs.memory_consumption());
+    report.set_item("direct_solver_factors", jacobian_factorized ? factor_memory : 0);
+
+    std::size_t cache_bytes = cell_cache.capacity() * sizeof(CellCache);
+    for (unsigned int i = 0; i < cell_cache.size(); ++i)
+        cache_bytes += cell_cache[i].matrix.memory_consumption() + cell_cache[i].rhs.memory_consumption()
+                + cell_cache[i].solution.memory_consumption();
+    report.set_item("cell_cache", cache_bytes);
+
+    report.set_item("interface_maps", interface_map.size()
+            * (2 * sizeof(std::pair<unsigned, unsigned>)) + interface_map_field.size()
+            * (sizeof(std::pair<unsigned, unsigned>) + sizeof(double)) + surface_face_index.size()
+            * (sizeof(std::pair<unsigned, unsigned>) + sizeof(unsigned)) + efield_values.capacity() * sizeof(double));
+    if (pq)
+        report.set_item("physical_quantities", pq->memory_consumption());
+    return report;
 }
 
 template class CurrentsAndHeatingStationary<2> ;
@@ -0,0 +1,106 @@
+/*
+ * element_kernels.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "element_kernels.h"
+
+namespace fch {
+using namespace dealii;
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::reinit(const FEValues<dim> &fe_values, const bool values,
+        const bool gradients) {
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        jxw[q] = fe_values.JxW(q);
+        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+            if (values)
+                phi[q * dofs_per_cell + i] = fe_values.shape_value(i, q);
+            if (gradients) {
+                const Tensor<1, dim> &grad = fe_values.shape_grad(i, q);
+                for (unsigned int d = 0; d < dim; ++d)
+                    grad_phi[(q * dim + d) * dofs_per_cell + i] = grad[d];
+            }
+        }
+    }
+}
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::add_stiffness(const QuadratureValues &coefficient,
+        LocalMatrix &matrix) const {
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        const double c = coefficient[q] * jxw[q];
+        const double *grad_q = &grad_phi[q * dim * dofs_per_cell];
+        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+            double *row = &matrix[i * dofs_per_cell];
+            for (unsigned int d = 0; d < dim; ++d) {
+                const double gi = c * grad_q[d * dofs_per_cell + i];
+                for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                    row[j] += gi * grad_q[d * dofs_per_cell + j];
+            }
+        }
+    }
+}
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::add_mass_stiffness(const QuadratureValues &mass_coefficient,
+        const QuadratureValues &stiffness_coefficient, LocalMatrix &matrix) const {
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        const double cm = mass_coefficient[q] * jxw[q];
+        const double *phi_q = &phi[q * dofs_per_cell];
+        for (unsigned int i = 0; i < dofs_per_cell; ++i) {
+            double *row = &matrix[i * dofs_per_cell];
+            const double mi = cm * phi_q[i];
+            for (unsigned int j = 0; j < dofs_per_cell; ++j)
+                row[j] += mi * phi_q[j];
+        }
+    }
+    add_stiffness(stiffness_coefficient, matrix);
+}
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::add_value_rhs(const QuadratureValues &coefficient,
+        LocalVector &rhs) const {
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        const double c = coefficient[q] * jxw[q];
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+            rhs[i] += c * phi[q * dofs_per_cell + i];
+    }
+}
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::add_gradient_rhs(
+        const std::array<Tensor<1, dim>, n_q_points> &vector, LocalVector &rhs) const {
+    for (unsigned int q = 0; q < n_q_points; ++q) {
+        for (unsigned int d = 0; d < dim; ++d) {
+            const double c = vector[q][d] * jxw[q];
+            for (unsigned int i = 0; i < dofs_per_cell; ++i)
+                rhs[i] += c * grad_phi[(q * dim + d) * dofs_per_cell + i];
+        }
+    }
+}
+
+template<int dim, int degree>
+void ElementKernel<dim, degree>::distribute_local_to_global(const LocalMatrix &matrix,
+        const LocalVector &rhs, const std::vector<types::global_dof_index> &local_dof_indices,
+        const ConstraintMatrix &constraints, SparseMatrix<double> &system_matrix,
+        Vector<double> &system_rhs) {
+    if (constrained_matrix.m() != dofs_per_cell) {
+        constrained_matrix.reinit(dofs_per_cell, dofs_per_cell);
+        constrained_rhs.reinit(dofs_per_cell);
+    }
+    constrained_matrix.fill(matrix.data());
+    for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        constrained_rhs(i) = rhs[i];
+
+    constraints.distribute_local_to_global(constrained_matrix, constrained_rhs, local_dof_indices,
+            system_matrix, system_rhs);
+}
+
+template class ElementKernel<2, 1> ;
+template class ElementKernel<2, 2> ;
+template class ElementKernel<3, 1> ;
+template class ElementKernel<3, 2> ;
+
+} // namespace fch
@@ -0,0 +1,181 @@
+/*
+ * heat_operator.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/base/quadrature_lib.h>
+#include <deal.II/fe/fe_update_flags.h>
+
+#include "heat_operator.h"
+
+namespace fch {
+using namespace dealii;
+
+template<int dim, int fe_degree>
+HeatOperator<dim, fe_degree>::HeatOperator() :
+        mass_coefficient(0.0), n_dofs(0) {
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::reinit(const DoFHandler<dim> &dof_handler,
+        const ConstraintMatrix &constraints) {
+
+    typename MatrixFree<dim, double>::AdditionalData additional_data;
+    additional_data.tasks_parallel_scheme = MatrixFree<dim, double>::AdditionalData::none;
+    additional_data.mapping_update_flags = update_values | update_gradients | update_JxW_values;
+
+    data.reinit(dof_handler, constraints, QGauss<1>(fe_degree + 1), additional_data);
+
+    n_dofs = dof_handler.n_dofs();
+    kappa.reinit(0, 0);
+    inverse_diagonal.reinit(0);
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::clear() {
+    data.clear();
+    kappa.reinit(0, 0);
+    inverse_diagonal.reinit(0);
+    n_dofs = 0;
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::set_coefficients(const double mass_coefficient_,
+        const Vector<double> &temperature, const PhysicalQuantities &pq) {
+
+    mass_coefficient = mass_coefficient_;
+
+    const unsigned int n_cells = data.n_macro_cells();
+    FEEval phi(data);
+    kappa.reinit(n_cells, phi.n_q_points);
+
+    for (unsigned int cell = 0; cell < n_cells; ++cell) {
+        phi.reinit(cell);
+        // the constrained entries carry the Dirichlet temperature and must be included
+        phi.read_dof_values_plain(temperature);
+        phi.evaluate(true, false);
+
+        const unsigned int n_filled = data.n_components_filled(cell);
+        for (unsigned int q = 0; q < phi.n_q_points; ++q) {
+            const VectorizedArray<double> t = phi.get_value(q);
+            kappa(cell, q) = 0.0;
+            for (unsigned int lane = 0; lane < n_filled; ++lane)
+                kappa(cell, q)[lane] = pq.kappa(t[lane]);
+        }
+    }
+
+    compute_inverse_diagonal();
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::do_quadrature(FEEval &phi, const unsigned int cell) const {
+    phi.evaluate(true, true);
+    for (unsigned int q = 0; q < phi.n_q_points; ++q) {
+        phi.submit_value(mass_coefficient * phi.get_value(q), q);
+        phi.submit_gradient(kappa(cell, q) * phi.get_gradient(q), q);
+    }
+    phi.integrate(true, true);
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::local_apply(const MatrixFree<dim, double> &data,
+        Vector<double> &dst, const Vector<double> &src,
+        const std::pair<unsigned int, unsigned int> &cell_range) const {
+
+    FEEval phi(data);
+    for (unsigned int cell = cell_range.first; cell < cell_range.second; ++cell) {
+        phi.reinit(cell);
+        phi.read_dof_values(src);
+        do_quadrature(phi, cell);
+        phi.distribute_local_to_global(dst);
+    }
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::local_apply_plain(const MatrixFree<dim, double> &data,
+        Vector<double> &dst, const Vector<double> &src,
+        const std::pair<unsigned int, unsigned int> &cell_range) const {
+
+    FEEval phi(data);
+    for (unsigned int cell = cell_range.first; cell < cell_range.second; ++cell) {
+        phi.reinit(cell);
+        phi.read_dof_values_plain(src);
+        do_quadrature(phi, cell);
+        phi.distribute_local_to_global(dst);
+    }
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::vmult(Vector<double> &dst, const Vector<double> &src) const {
+    dst = 0;
+    data.cell_loop(&HeatOperator::local_apply, this, dst, src);
+
+    const std::vector<unsigned int> &constrained_dofs = data.get_constrained_dofs();
+    for (unsigned int i = 0; i < constrained_dofs.size(); ++i)
+        dst(constrained_dofs[i]) = src(constrained_dofs[i]);
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::Tvmult(Vector<double> &dst, const Vector<double> &src) const {
+    vmult(dst, src);
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::apply_lifting(Vector<double> &dst,
+        const Vector<double> &lift) const {
+    dst.reinit(n_dofs);
+    // distribute_local_to_global skips the constrained rows, so they stay zero
+    data.cell_loop(&HeatOperator::local_apply_plain, this, dst, lift);
+}
+
+template<int dim, int fe_degree>
+void HeatOperator<dim, fe_degree>::compute_inverse_diagonal() {
+
+    inverse_diagonal.reinit(n_dofs);
+
+    FEEval phi(data);
+    AlignedVector<VectorizedArray<double> > diagonal(phi.dofs_per_cell);
+
+    for (unsigned int cell = 0; cell < data.n_macro_cells(); ++cell) {
+        phi.reinit(cell);
+        for (unsigned int i = 0; i < phi.dofs_per_cell; ++i) {
+            for (unsigned int j = 0; j < phi.dofs_per_cell; ++j)
+                phi.begin_dof_values()[j] = 0.0;
+            phi.begin_dof_values()[i] = 1.0;
+            do_quadrature(phi, cell);
+            diagonal[i] = phi.begin_dof_values()[i];
+        }
+        for (unsigned int i = 0; i < phi.dofs_per_cell; ++i)
+            phi.begin_dof_values()[i] = diagonal[i];
+        phi.distribute_local_to_global(inverse_diagonal);
+    }
+
+    const std::vector<unsigned int> &constrained_dofs = data.get_constrained_dofs();
+    for (unsigned int i = 0; i < constrained_dofs.size(); ++i)
+        inverse_diagonal(constrained_dofs[i]) = 1.0;
+
+    for (unsigned int i = 0; i < n_dofs; ++i)
+        inverse_diagonal(i) = 1.0 / inverse_diagonal(i);
+}
+
+template<int dim, int fe_degree>
+std::size_t HeatOperator<dim, fe_degree>::memory_consumption() const {
+    return data.memory_consumption() + kappa.memory_consumption()
+            + inverse_diagonal.memory_consumption();
+}
+
+template<int dim, int fe_degree>
+double HeatOperator<dim, fe_degree>::el(const unsigned int row, const unsigned int col) const {
+    Assert(row == col, ExcNotImplemented());
+    Assert(inverse_diagonal.size() == n_dofs, ExcNotInitialized());
+    (void) col;
+    return 1.0 / inverse_diagonal(row);
+}
+
+template class HeatOperator<2, 1> ;
+template class HeatOperator<2, 2> ;
+template class HeatOperator<3, 1> ;
+template class HeatOperator<3, 2> ;
+
+} // namespace fch
@@ -26,7 +26,11 @@
 #include <deal.II/lac/solver_cg.h>
 #include <deal.II/lac/precondition.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include "laplace.h"
+#include "sparsity_builder.h"
 
 namespace fch {
 using namespace dealii;
@@ -59,7 +63,9 @@ public:
 
 template<int dim>
 Laplace<dim>::Laplace() :
-		applied_efield(applied_efield_default), fe(shape_degree), dof_handler(triangulation) {
+		applied_efield(applied_efield_default), fe(shape_degree), dof_handler(triangulation),
+		solver_cg(solver_control), n_iterations(0), ssor_autotuning(false), mixed_precision(MixedPrecisionCG::off),
+		tracer(NULL), use_congruent_cell_cache(false), signature_quantum(0.0) {
 }
 
 template<int dim>
@@ -78,6 +84,24 @@ void Laplace<dim>::set_applied_efield(const double applied_field_) {
 	applied_efield = applied_field_;
 }
 
+template<int dim>
+bool Laplace<dim>::rescale_applied_efield(const double applied_field_) {
+	if (applied_efield == 0.0)
+		return false;
+
+	const double ratio = applied_field_ / applied_efield;
+	system_rhs *= ratio;
+	solution *= ratio;
+	applied_efield = applied_field_;
+	return true;
+}
+
+
+template<int dim>
+void Laplace<dim>::set_congruent_cell_cache(const bool enable) {
+	use_congruent_cell_cache = enable;
+	congruent_cell_matrices.clear();
+}
 
 template<int dim>
 void Laplace<dim>::import_mesh_from_file(const std::string file_name) {
@@ -121,6 +145,28 @@ double Laplace<dim>::probe_efield(const Point<dim> &p) const {
 	return VectorTools::point_gradient (dof_handler, solution, p).norm();
 }
 
+template<int dim>
+double Laplace<dim>::get_max_surface_field() const {
+	QGauss<dim-1> face_quadrature_formula(quadrature_degree);
+	FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula, update_gradients);
+
+	std::vector<Tensor<1, dim> > solution_gradients(face_quadrature_formula.size());
+
+	double max_field = 0.0;
+	typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc = dof_handler.end();
+	for (; cell != endc; ++cell) {
+		for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f) {
+			if (cell->face(f)->at_boundary() && cell->face(f)->boundary_id() == BoundaryId::copper_surface) {
+				fe_face_values.reinit(cell, f);
+				fe_face_values.get_function_gradients(solution, solution_gradients);
+				for (unsigned int q = 0; q < face_quadrature_formula.size(); ++q)
+					max_field = std::max(max_field, solution_gradients[q].norm());
+			}
+		}
+	}
+	return max_field;
+}
+
 template<int dim>
 std::vector<double> Laplace<dim>::get_potential(const std::vector<int> &cell_indexes,
 												const std::vector<int> &vert_indexes) {
@@ -166,60 +212,140 @@ std::vector<Tensor<1, dim> > Laplace<dim>::get_efield(const std::vector<int> &ce
     return fields;
 }
 
+template<int dim>
+void Laplace<dim>::set_ssor_autotuning(const bool enable) {
+	ssor_autotuning = enable;
+	ssor_tuner.restart();
+}
+
+template<int dim>
+void Laplace<dim>::set_trace_recorder(TraceRecorder *recorder) {
+	tracer = recorder;
+}
+
+template<int dim>
+void Laplace<dim>::set_mixed_precision(const MixedPrecisionCG::Mode mode) {
+	mixed_precision = mode;
+}
+
 template<int dim>
 void Laplace<dim>::setup_system() {
+	TraceRecorder::Scope trace(tracer, "Laplace::setup_system");
+
 	dof_handler.distribute_dofs(fe);
 
 	//std::cout << "    Number of degrees of freedom: " << dof_handler.n_dofs() << std::endl;
 
-	DynamicSparsityPattern dsp(dof_handler.n_dofs());
-	DoFTools::make_sparsity_pattern(dof_handler, dsp);
-	sparsity_pattern.copy_from(dsp);
+	// Dirichlet boundary (zero potential) condition on the copper surface
+	constraints.clear();
+	VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_surface,
+			ZeroFunction<dim>(), constraints);
+	constraints.close();
+
+	make_static_sparsity_pattern(dof_handler, constraints, sparsity_pattern);
 
 	system_matrix.reinit(sparsity_pattern);
 
 	solution.reinit(dof_handler.n_dofs());
 	system_rhs.reinit(dof_handler.n_dofs());
+
+	assembly_scratch.reset(new AssemblyScratch(fe));
+	congruent_cell_matrices.clear();
+
+	// Length scale for rounding the cell shape signatures; cells with vertices matching
+	// up to a relative 1e-9 of the mesh extent are treated as congruent
+	const std::vector<Point<dim> > &vertices = triangulation.get_vertices();
+	const std::vector<bool> &used_vertices = triangulation.get_used_vertices();
+	Point<dim> lower, upper;
+	bool first = true;
+	for (unsigned int i = 0; i < vertices.size(); ++i) {
+		if (!used_vertices[i])
+			continue;
+		for (unsigned int d = 0; d < dim; ++d) {
+			lower[d] = first ? vertices[i][d] : std::min(lower[d], vertices[i][d]);
+			upper[d] = first ? vertices[i][d] : std::max(upper[d], vertices[i][d]);
+		}
+		first = false;
+	}
+	signature_quantum = 1e-9 * lower.distance(upper);
+
+	mass_matrix.clear();
+	mass_sparsity_pattern.reinit(0, 0, 0);
+
+	memory_report.record_phase("setup");
+}
+
+template<int dim>
+typename Laplace<dim>::CellSignature Laplace<dim>::cell_signature(
+		const typename DoFHandler<dim>::active_cell_iterator &cell) const {
+	CellSignature signature;
+
+	const Point<dim> origin = cell->vertex(0);
+	for (unsigned int v = 1; v < GeometryInfo<dim>::vertices_per_cell; ++v)
+		for (unsigned int d = 0; d < dim; ++d)
+			signature[(v - 1) * dim + d] = std::llround((cell->vertex(v)[d] - origin[d]) / signature_quantum);
+
+	return signature;
 }
 
 template<int dim>
 void Laplace<dim>::assemble_system() {
-	QGauss<dim> quadrature_formula(quadrature_degree);
-	QGauss<dim-1> face_quadrature_formula(quadrature_degree);
+	TraceRecorder::Scope trace(tracer, "Laplace::assemble_system");
 
-	FEValues<dim> fe_values(fe, quadrature_formula,
-			update_gradients | update_quadrature_points | update_JxW_values);
+	system_matrix = 0;
+	system_rhs = 0;
 
-	FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula,
-				update_values | update_quadrature_points | update_JxW_values);
+	// The finite element values are created once in setup_system
+	Assert(assembly_scratch, ExcNotInitialized());
+	FEValues<dim> &fe_values = assembly_scratch->fe_values;
+	FEFaceValues<dim> &fe_face_values = assembly_scratch->fe_face_values;
 
-	const unsigned int dofs_per_cell = fe.dofs_per_cell;
-	const unsigned int n_q_points = quadrature_formula.size();
-	const unsigned int n_face_q_points = face_quadrature_formula.size();
+	// Fixed size local matrices with the element size known at compile time
+	typedef ElementKernel<dim, shape_degree> Kernel;
+	Kernel &kernel = assembly_scratch->kernel;
 
-	FullMatrix<double> cell_matrix(dofs_per_cell, dofs_per_cell);
-	Vector<double> cell_rhs(dofs_per_cell);
+	const unsigned int dofs_per_cell = Kernel::dofs_per_cell;
+	const unsigned int n_face_q_points = assembly_scratch->face_quadrature.size();
+	Assert(assembly_scratch->quadrature.size() == Kernel::n_q_points, ExcInternalError());
 
-	std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+	typename Kernel::LocalMatrix cell_matrix;
+	typename Kernel::LocalVector cell_rhs;
+
+	typename Kernel::QuadratureValues unit_coefficient;
+	unit_coefficient.fill(1.0);
+
+	std::vector<types::global_dof_index> &local_dof_indices = assembly_scratch->local_dof_indices;
 
 	typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc = dof_handler.end();
 
 	// Iterate over all cells (quadrangles in 2D, hexahedra in 3D) of the mesh
 	for (; cell != endc; ++cell) {
-		fe_values.reinit(cell);
-		cell_matrix = 0;
-		cell_rhs = 0;
+		cell_rhs.fill(0.0);
+
+		// The stiffness matrix depends only on the cell shape, so the translated copies
+		// of an already assembled cell reuse its local matrix
+		typename std::map<CellSignature, LocalMatrix>::iterator cached = congruent_cell_matrices.end();
+		CellSignature signature;
+		if (use_congruent_cell_cache) {
+			signature = cell_signature(cell);
+			cached = congruent_cell_matrices.find(signature);
+		}
 
-		// Assemble system matrix elements corresponding the current cell
-		for (unsigned int q = 0; q < n_q_points; ++q) {
-			for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-				for (unsigned int j = 0; j < dofs_per_cell; ++j)
-					cell_matrix(i, j) += (fe_values.shape_grad(i, q) * fe_values.shape_grad(j, q)
-							* fe_values.JxW(q));
+		if (cached != congruent_cell_matrices.end()) {
+			cell_matrix = cached->second;
+		} else {
+			fe_values.reinit(cell);
+			kernel.reinit(fe_values, false, true);
+			cell_matrix.fill(0.0);
 
-				// Uncomment the next line to obtain Poisson equation
-				//cell_rhs(i) += (fe_values.shape_value(i, q_index) * charge_density * fe_values.JxW(q_index));
-			}
+			// Assemble system matrix elements corresponding the current cell
+			kernel.add_stiffness(unit_coefficient, cell_matrix);
+
+			// Uncomment the next line to obtain Poisson equation
+			//kernel.add_value_rhs(charge_density, cell_rhs);
+
+			if (use_congruent_cell_cache)
+				congruent_cell_matrices.insert(std::make_pair(signature, cell_matrix));
 		}
 
 		// Apply Neumann boundary condition at faces on top of vacuum domain
@@ -229,50 +355,251 @@ void Laplace<dim>::assemble_system() {
 
 				for (unsigned int q = 0; q < n_face_q_points; ++q) {
 					for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-						cell_rhs(i) += (fe_face_values.shape_value(i, q)
+						cell_rhs[i] += (fe_face_values.shape_value(i, q)
 								* applied_efield * fe_face_values.JxW(q));
 					}
 				}
 			}
 		}
 
-		// Add the current cell matrix and rhs entries to the system sparse matrix
+		// Add the current cell matrix and rhs entries to the system sparse matrix;
+		// the Dirichlet condition on the copper surface is applied by the constraints
 		cell->get_dof_indices(local_dof_indices);
-		for (unsigned int i = 0; i < dofs_per_cell; ++i) {
-			for (unsigned int j = 0; j < dofs_per_cell; ++j)
-				system_matrix.add(local_dof_indices[i], local_dof_indices[j], cell_matrix(i, j));
+		kernel.distribute_local_to_global(cell_matrix, cell_rhs, local_dof_indices, constraints,
+				system_matrix, system_rhs);
+	}
+
+	memory_report.record_phase("assemble");
+}
 
-			system_rhs(local_dof_indices[i]) += cell_rhs(i);
+template<int dim>
+SolveStats Laplace<dim>::solve(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+	TraceRecorder::Scope trace(tracer, "Laplace::solve");
+	Timer timer;
+	SolveStats stats;
+
+	const bool tune = pc_ssor && ssor_autotuning;
+	if (tune)
+		ssor_param = ssor_tuner.get_omega();
+	if (pc_ssor)
+		stats.ssor_param = ssor_param;
+
+	if (pc_ssor && mixed_precision != MixedPrecisionCG::off) {
+		mixed_precision_cg.initialize(system_matrix, ssor_param);
+		try {
+			n_iterations = mixed_precision_cg.solve(mixed_precision, system_matrix, solution, system_rhs,
+					max_iter, tol);
+		} catch (SolverControl::NoConvergence &) {
+			// the failed omega costs at least max_iter; without the result the search would be stuck on it
+			if (tune)
+				ssor_tuner.add_result(max_iter);
+			throw;
 		}
+		constraints.distribute(solution);
+		if (tracer)
+			tracer->counter("laplace_cg_iterations", n_iterations);
+		memory_report.record_phase("solve");
+
+		stats.iterations = n_iterations;
+		stats.residual_history = mixed_precision_cg.get_residual_history();
+		if (!stats.residual_history.empty())
+			stats.residual = stats.residual_history.back();
+		if (tune)
+			ssor_tuner.add_result(n_iterations);
+		stats.wall_time = timer.wall_time();
+		return stats;
 	}
 
-	// Apply Dirichlet boundary (zero potential) condition on the copper surface
-	// ZeroFunction<dim>() == zero
-	std::map<types::global_dof_index, double> boundary_values;
-	VectorTools::interpolate_boundary_values(dof_handler, BoundaryId::copper_surface,
-			ZeroFunction<dim>(), boundary_values);
-	MatrixTools::apply_boundary_values(boundary_values, system_matrix, solution, system_rhs);
+	solver_control.set_max_steps(max_iter);
+	solver_control.set_tolerance(tol);
+
+	try {
+		if (pc_ssor) {
+			preconditioner_ssor.initialize(system_matrix, ssor_param);
+			solver_cg.solve(system_matrix, solution, system_rhs, preconditioner_ssor);
+		} else {
+			solver_cg.solve(system_matrix, solution, system_rhs, PreconditionIdentity());
+		}
+	} catch (SolverControl::NoConvergence &) {
+		if (tune)
+			ssor_tuner.add_result(max_iter);
+		throw;
+	}
+	n_iterations = solver_control.last_step();
+
+	constraints.distribute(solution);
+	if (tracer) {
+		tracer->counter("laplace_cg_iterations", n_iterations);
+		tracer->counter("laplace_cg_residual", solver_control.last_value());
+		if (pc_ssor)
+			tracer->counter("laplace_ssor_param", ssor_param);
+	}
+	memory_report.record_phase("solve");
+
+	solver_control.fill(stats);
+	if (tune)
+		ssor_tuner.add_result(n_iterations);
+	stats.wall_time = timer.wall_time();
+	return stats;
+}
+
+template<int dim>
+std::future<SolveStats> Laplace<dim>::solve_async(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+	return worker.submit([this, max_iter, tol, pc_ssor, ssor_param]() {
+		return solve(max_iter, tol, pc_ssor, ssor_param);
+	});
+}
+
+template<int dim>
+void Laplace<dim>::assemble_rhs(const Function<dim> &top_field_profile, Vector<double> &rhs) const {
+	rhs.reinit(dof_handler.n_dofs());
+
+	QGauss<dim-1> face_quadrature_formula(quadrature_degree);
+	FEFaceValues<dim> fe_face_values(fe, face_quadrature_formula,
+				update_values | update_quadrature_points | update_JxW_values);
+
+	const unsigned int dofs_per_cell = fe.dofs_per_cell;
+	const unsigned int n_face_q_points = face_quadrature_formula.size();
+
+	Vector<double> cell_rhs(dofs_per_cell);
+	std::vector<types::global_dof_index> local_dof_indices(dofs_per_cell);
+
+	typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active(), endc = dof_handler.end();
+	for (; cell != endc; ++cell) {
+		if (!cell->at_boundary())
+			continue;
+
+		cell_rhs = 0;
+		bool has_top_face = false;
+
+		// Neumann boundary condition at faces on top of vacuum domain
+		for (unsigned int f = 0; f < GeometryInfo<dim>::faces_per_cell; ++f) {
+			if (cell->face(f)->at_boundary() && cell->face(f)->boundary_id() == BoundaryId::vacuum_top) {
+				fe_face_values.reinit(cell, f);
+				has_top_face = true;
+
+				for (unsigned int q = 0; q < n_face_q_points; ++q) {
+					const double field = top_field_profile.value(fe_face_values.quadrature_point(q));
+					for (unsigned int i = 0; i < dofs_per_cell; ++i)
+						cell_rhs[i] += fe_face_values.shape_value(i, q) * field * fe_face_values.JxW(q);
+				}
+			}
+		}
+
+		if (has_top_face) {
+			cell->get_dof_indices(local_dof_indices);
+			constraints.distribute_local_to_global(cell_rhs, local_dof_indices, rhs);
+		}
+	}
 }
 
 template<int dim>
-void Laplace<dim>::solve(int max_iter, double tol, bool pc_ssor, double ssor_param) {
+SolveStats Laplace<dim>::solve_multiple(const std::vector<Vector<double> > &rhs,
+		std::vector<Vector<double> > &solutions, int max_iter, double tol, bool pc_ssor,
+		double ssor_param) {
+	TraceRecorder::Scope trace(tracer, "Laplace::solve_multiple");
+	Timer timer;
+
+	solutions.resize(rhs.size());
+	const unsigned int n_steps = multi_vector_cg.solve(system_matrix, rhs, solutions, max_iter,
+			tol, pc_ssor, ssor_param);
+	if (tracer)
+		tracer->counter("laplace_cg_iterations", n_steps);
+
+	for (unsigned int i = 0; i < solutions.size(); ++i)
+		constraints.distribute(solutions[i]);
+	memory_report.record_phase("solve");
+
+	SolveStats stats;
+	stats.iterations = n_steps;
+	stats.ssor_param = pc_ssor ? ssor_param : 0.0;
+	stats.wall_time = timer.wall_time();
+	return stats;
+}
+
+template<int dim>
+SolveStats Laplace<dim>::solve_space_charge(const SpaceChargeFunction &space_charge,
+		unsigned int max_outer_iter, double outer_tol, unsigned int anderson_depth, double mixing,
+		int max_iter, double tol, double ssor_param) {
+	TraceRecorder::Scope trace(tracer, "Laplace::solve_space_charge");
+	Timer timer;
+	SolveStats stats;
+	stats.ssor_param = ssor_param;
+
+	const unsigned int n_dofs = dof_handler.n_dofs();
+
+	// The mass matrix depends only on the mesh; build it on the first call after setup_system
+	if (mass_matrix.m() != n_dofs) {
+		make_static_sparsity_pattern(dof_handler, mass_sparsity_pattern);
+		mass_matrix.reinit(mass_sparsity_pattern);
+		MatrixCreator::create_mass_matrix(dof_handler, QGauss<dim>(quadrature_degree), mass_matrix);
+	}
+
+	boundary_rhs = system_rhs;
+	charge_density.reinit(n_dofs);
+	space_charge_rhs.reinit(n_dofs);
+
+	solver_control.set_max_steps(max_iter);
+	solver_control.set_tolerance(tol);
+	preconditioner_ssor.initialize(system_matrix, ssor_param);
+
+	// Start from the solution without the space charge
+	if (solution.l2_norm() == 0.0) {
+		solver_cg.solve(system_matrix, solution, boundary_rhs, preconditioner_ssor);
+		constraints.distribute(solution);
+	}
+
+	anderson_mixer.reinit(anderson_depth, mixing);
+	space_charge_update = solution;
 
-	SolverControl solver_control(max_iter, tol);
-	SolverCG<> solver(solver_control);
+	for (unsigned int iteration = 1; iteration <= max_outer_iter; ++iteration) {
+		TraceRecorder::Scope iteration_trace(tracer, "space_charge_iteration");
 
-	if (pc_ssor) {
-		PreconditionSSOR<> preconditioner;
-		preconditioner.initialize(system_matrix, ssor_param);
-		solver.solve(system_matrix, solution, system_rhs, preconditioner);
-	} else {
-		solver.solve(system_matrix, solution, system_rhs, PreconditionIdentity());
+		space_charge(*this, charge_density);
+		Assert(charge_density.size() == n_dofs, ExcDimensionMismatch(charge_density.size(), n_dofs));
+
+		space_charge_rhs = boundary_rhs;
+		mass_matrix.vmult_add(space_charge_rhs, charge_density);
+		constraints.set_zero(space_charge_rhs);
+
+		// warm start from the previous Poisson solution
+		solver_cg.solve(system_matrix, space_charge_update, space_charge_rhs, preconditioner_ssor);
+		constraints.distribute(space_charge_update);
+
+		double change = 0.0;
+		for (unsigned int i = 0; i < n_dofs; ++i)
+			change += (space_charge_update(i) - solution(i)) * (space_charge_update(i) - solution(i));
+		change = std::sqrt(change) / std::max(space_charge_update.l2_norm(), 1e-300);
+		if (tracer) {
+			tracer->counter("laplace_cg_iterations", solver_control.last_step());
+			tracer->counter("space_charge_change", change);
+		}
+
+		stats.iterations = iteration;
+		stats.residual = change;
+		stats.residual_history.push_back(change);
+
+		if (change < outer_tol) {
+			solution = space_charge_update;
+			system_rhs = space_charge_rhs;
+			stats.wall_time = timer.wall_time();
+			return stats;
+		}
+
+		anderson_mixer.update(solution, space_charge_update);
+		constraints.distribute(solution);
 	}
 
-	//std::cout << "   " << solver_control.last_step() << " CG iterations needed to obtain convergence." << std::endl;
+	system_rhs = space_charge_rhs;
+	stats.converged = false;
+	stats.wall_time = timer.wall_time();
+	return stats;
 }
 
 template<int dim>
 void Laplace<dim>::output_results(const std::string filename) const {
+	TraceRecorder::Scope trace(tracer, "Laplace::output_results");
+
 	LaplacePostProcessor<dim> field_calculator; // needs to be before data_out
 	DataOut<dim> data_out;
 
@@ -289,23 +616,58 @@ void Laplace<dim>::output_results(const std::string filename) const {
 		std::cerr << "WARNING: Couldn't open " + filename << ". ";
 		std::cerr << "Output is not saved." << std::endl;
 	}
+
+	memory_report.record_phase("output");
 }
 
 template<int dim>
-void Laplace<dim>::run() {
-	Timer timer;
+MemoryReport Laplace<dim>::get_memory_report() const {
+	MemoryReport report = memory_report;
+	report.set_item("triangulation", triangulation.memory_consumption());
+	report.set_item("dof_handler", dof_handler.memory_consumption());
+	report.set_item("constraints", constraints.memory_consumption());
+	report.set_item("sparsity_patterns",
+			sparsity_pattern.memory_consumption() + mass_sparsity_pattern.memory_consumption());
+	report.set_item("matrices", system_matrix.memory_consumption() + mass_matrix.memory_consumption());
+	report.set_item("vectors", solution.memory_consumption() + system_rhs.memory_consumption()
+			+ boundary_rhs.memory_consumption() + charge_density.memory_consumption()
+			+ space_charge_rhs.memory_consumption() + space_charge_update.memory_consumption());
+	report.set_item("solver_workspace", mixed_precision_cg.memory_consumption()
+			+ multi_vector_cg.memory_consumption());
+	report.set_item("cell_matrix_cache", congruent_cell_matrices.size()
+			* (sizeof(LocalMatrix) + sizeof(CellSignature)));
+	return report;
+}
+
+template<int dim>
+LaplaceRunStats Laplace<dim>::run() {
+	Timer timer, run_timer;
+	LaplaceRunStats stats;
 	std::cout << "/---------------------------------------------------------------/" << std::endl;
 	std::cout << "Laplace solver: " << std::endl;
 	setup_system();
-	std::cout << "    setup_system(): " << timer.wall_time() << " s" << std::endl; timer.restart();
+	stats.setup_time = timer.wall_time(); timer.restart();
+	std::cout << "    setup_system(): " << stats.setup_time << " s" << std::endl;
 	assemble_system();
-	std::cout << "    assemble_system(): " << timer.wall_time() << " s" << std::endl; timer.restart();
-	solve();
-	std::cout << "    solve(): " << timer.wall_time() << " s" << std::endl; timer.restart();
+	stats.assemble_time = timer.wall_time(); timer.restart();
+	std::cout << "    assemble_system(): " << stats.assemble_time << " s" << std::endl;
+	stats.solve = solve();
+	stats.solve_time = timer.wall_time(); timer.restart();
+	std::cout << "    solve(): " << stats.solve_time << " s, " << stats.solve.iterations << " CG iterations" << std::endl;
 	output_results("output/field_solution.vtk");
-	std::cout << "    output_results(): " << timer.wall_time() << " s" << std::endl; timer.restart();
+	stats.output_time = timer.wall_time(); timer.restart();
+	std::cout << "    output_results(): " << stats.output_time << " s" << std::endl;
     std::cout << "/---------------------------------------------------------------/" << std::endl;
 
+	stats.wall_time = run_timer.wall_time();
+	return stats;
+}
+
+template<int dim>
+std::future<LaplaceRunStats> Laplace<dim>::run_async() {
+	return worker.submit([this]() {
+		return run();
+	});
 }
 
 template class Laplace<2> ;
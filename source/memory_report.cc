@@ -0,0 +1,83 @@
+/*
+ * memory_report.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/base/utilities.h>
+
+#include <cstdio>
+
+#include "memory_report.h"
+
+namespace fch {
+using namespace dealii;
+
+namespace {
+void set_value(std::vector<std::pair<std::string, std::size_t> > &values, const std::string &name,
+        const std::size_t bytes) {
+    for (unsigned int i = 0; i < values.size(); ++i)
+        if (values[i].first == name) {
+            values[i].second = bytes;
+            return;
+        }
+    values.push_back(std::make_pair(name, bytes));
+}
+}
+
+void MemoryReport::set_item(const std::string &name, const std::size_t bytes) {
+    set_value(items, name, bytes);
+}
+
+void MemoryReport::record_phase(const std::string &phase) {
+    set_value(phases, phase, peak_rss());
+}
+
+void MemoryReport::clear_phases() {
+    phases.clear();
+}
+
+std::size_t MemoryReport::total() const {
+    std::size_t sum = 0;
+    for (unsigned int i = 0; i < items.size(); ++i)
+        sum += items[i].second;
+    return sum;
+}
+
+std::size_t MemoryReport::peak_rss() {
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats(stats);
+    return std::size_t(stats.VmHWM) * 1024;
+}
+
+std::size_t MemoryReport::current_rss() {
+    Utilities::System::MemoryStats stats;
+    Utilities::System::get_memory_stats(stats);
+    return std::size_t(stats.VmRSS) * 1024;
+}
+
+std::ostream& operator <<(std::ostream &os, const MemoryReport &report) {
+    const double mb = 1.0 / (1024.0 * 1024.0);
+    char line[128];
+
+    os << "    Memory (MB):";
+    for (unsigned int i = 0; i < report.items.size(); ++i) {
+        std::snprintf(line, sizeof(line), "\n        %-24s %10.2f", report.items[i].first.c_str(),
+                report.items[i].second * mb);
+        os << line;
+    }
+    std::snprintf(line, sizeof(line), "\n        %-24s %10.2f", "total", report.total() * mb);
+    os << line;
+
+    if (!report.phases.empty()) {
+        os << "\n    Peak RSS after phase (MB):";
+        for (unsigned int i = 0; i < report.phases.size(); ++i) {
+            std::snprintf(line, sizeof(line), "\n        %-24s %10.2f",
+                    report.phases[i].first.c_str(), report.phases[i].second * mb);
+            os << line;
+        }
+    }
+    return os;
+}
+
+} // namespace fch
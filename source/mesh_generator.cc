@@ -0,0 +1,184 @@
+/*
+ * mesh_generator.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/base/geometry_info.h>
+#include <deal.II/grid/grid_reordering.h>
+
+#include <cmath>
+
+#include "mesh_generator.h"
+#include "mesh_preparer.h"
+
+namespace fch {
+using namespace dealii;
+
+template<int dim>
+MeshGenerator<dim>::MeshGenerator() :
+        tip_height(20.0), tip_radius(3.0), box_width(80.0), vacuum_height(100.0),
+        copper_depth(40.0), n_lateral(32), n_vacuum_layers(16), n_copper_layers(16),
+        lateral_grading(1.0), vertical_grading(1.0) {
+}
+
+template<int dim>
+void MeshGenerator<dim>::set_tip(const double height, const double radius) {
+    Assert(height >= 0.0 && radius > 0.0, ExcMessage("Invalid tip dimensions"));
+    tip_height = height;
+    tip_radius = radius;
+}
+
+template<int dim>
+void MeshGenerator<dim>::set_box(const double width, const double vacuum_height_,
+        const double copper_depth_) {
+    Assert(width > 0.0 && copper_depth_ > 0.0, ExcMessage("Invalid box dimensions"));
+    box_width = width;
+    vacuum_height = vacuum_height_;
+    copper_depth = copper_depth_;
+}
+
+template<int dim>
+void MeshGenerator<dim>::set_resolution(const unsigned int n_lateral_,
+        const unsigned int n_vacuum_layers_, const unsigned int n_copper_layers_) {
+    Assert(n_lateral_ > 0 && n_vacuum_layers_ > 0 && n_copper_layers_ > 0,
+            ExcMessage("Every direction needs at least one cell"));
+    n_lateral = n_lateral_;
+    n_vacuum_layers = n_vacuum_layers_;
+    n_copper_layers = n_copper_layers_;
+}
+
+template<int dim>
+void MeshGenerator<dim>::set_target_cells(const unsigned long n_cells) {
+    // n_lateral^(dim-1) * (2 * n_layers) cells with n_layers = n_lateral / 2
+    const unsigned int n = std::max(2.0, std::round(std::pow(double(n_cells), 1.0 / dim)));
+    const unsigned int n_layers = std::max(1u, n / 2);
+    set_resolution(n, n_layers, n_layers);
+}
+
+template<int dim>
+void MeshGenerator<dim>::set_grading(const double lateral, const double vertical) {
+    Assert(lateral > 0.0 && vertical > 0.0, ExcMessage("Grading exponents must be positive"));
+    lateral_grading = lateral;
+    vertical_grading = vertical;
+}
+
+template<int dim>
+unsigned long MeshGenerator<dim>::n_vacuum_cells() const {
+    return std::pow(n_lateral, dim - 1) * n_vacuum_layers;
+}
+
+template<int dim>
+unsigned long MeshGenerator<dim>::n_copper_cells() const {
+    return std::pow(n_lateral, dim - 1) * n_copper_layers;
+}
+
+template<int dim>
+double MeshGenerator<dim>::surface_height(const double r) const {
+    if (tip_height == 0.0)
+        return 0.0;
+    return tip_height * std::exp(-r * r / (2.0 * tip_radius * tip_height));
+}
+
+template<int dim>
+double MeshGenerator<dim>::lateral_coordinate(const unsigned int i) const {
+    const double xi = 2.0 * i / n_lateral - 1.0;
+    const double graded = std::pow(std::abs(xi), lateral_grading);
+    return 0.5 * box_width * (xi < 0 ? -graded : graded);
+}
+
+template<int dim>
+void MeshGenerator<dim>::make_mesh_data(const bool vacuum, std::vector<Point<dim> > &vertices,
+        std::vector<CellData<dim> > &cells) const {
+
+    Assert(vacuum_height > tip_height, ExcMessage("Vacuum top must be above the tip apex"));
+
+    const unsigned int n_layers = vacuum ? n_vacuum_layers : n_copper_layers;
+    const unsigned int nv = n_lateral + 1;                      // vertices along a lateral direction
+    const unsigned int n_layer_vertices = dim == 3 ? nv * nv : nv;
+    const unsigned int n_layer_cells = dim == 3 ? n_lateral * n_lateral : n_lateral;
+
+    std::vector<double> coordinates(nv);
+    for (unsigned int i = 0; i < nv; ++i)
+        coordinates[i] = lateral_coordinate(i);
+
+    vertices.resize(n_layer_vertices * (n_layers + 1));
+    for (unsigned int l = 0; l < n_layer_vertices; ++l) {
+        Point<dim> p;
+        p[0] = coordinates[l % nv];
+        if (dim == 3)
+            p[1] = coordinates[l / nv];
+        const double r = dim == 3 ? std::hypot(p[0], p[1]) : std::abs(p[0]);
+
+        // the interface layer is evaluated identically for both meshes
+        const double h = surface_height(r);
+
+        for (unsigned int k = 0; k <= n_layers; ++k) {
+            if (vacuum) {
+                // layer 0 on the surface, refined towards it
+                const double s = std::pow(double(k) / n_layers, vertical_grading);
+                p[dim - 1] = k == 0 ? h : h + (vacuum_height - h) * s;
+            } else {
+                // layer n_layers on the surface, refined towards it
+                const double s = std::pow(double(n_layers - k) / n_layers, vertical_grading);
+                p[dim - 1] = k == n_layers ? h : h - (h + copper_depth) * s;
+            }
+            vertices[k * n_layer_vertices + l] = p;
+        }
+    }
+
+    // lexicographic vertex numbering of the cells
+    cells.resize(n_layer_cells * n_layers);
+    unsigned int c = 0;
+    for (unsigned int k = 0; k < n_layers; ++k) {
+        const unsigned int bottom = k * n_layer_vertices;
+        const unsigned int top = bottom + n_layer_vertices;
+        for (unsigned int j = 0; j < (dim == 3 ? n_lateral : 1); ++j)
+            for (unsigned int i = 0; i < n_lateral; ++i, ++c) {
+                const unsigned int l = j * nv + i;
+                for (unsigned int v = 0; v < GeometryInfo<dim>::vertices_per_cell; ++v) {
+                    const bool upper = dim == 3 ? (v & 4) : (v & 2);
+                    unsigned int index = (upper ? top : bottom) + l;
+                    if (v & 1)
+                        index += 1;
+                    if (dim == 3 && (v & 2))
+                        index += nv;
+                    cells[c].vertices[v] = index;
+                }
+                cells[c].material_id = 0;
+            }
+    }
+}
+
+template<int dim>
+void MeshGenerator<dim>::generate_vacuum_mesh(Triangulation<dim> *triangulation) const {
+    std::vector<Point<dim> > vertices;
+    std::vector<CellData<dim> > cells;
+    make_mesh_data(true, vertices, cells);
+
+    GridReordering<dim, dim>::invert_all_cells_of_negative_grid(vertices, cells);
+    triangulation->clear();
+    triangulation->create_triangulation(vertices, cells, SubCellData());
+
+    MeshPreparer<dim> mesh_preparer;
+    mesh_preparer.mark_vacuum_boundary(triangulation);
+}
+
+template<int dim>
+void MeshGenerator<dim>::generate_copper_mesh(Triangulation<dim> *triangulation) const {
+    std::vector<Point<dim> > vertices;
+    std::vector<CellData<dim> > cells;
+    make_mesh_data(false, vertices, cells);
+
+    GridReordering<dim, dim>::invert_all_cells_of_negative_grid(vertices, cells);
+    triangulation->clear();
+    triangulation->create_triangulation(vertices, cells, SubCellData());
+
+    MeshPreparer<dim> mesh_preparer;
+    mesh_preparer.mark_copper_boundary(triangulation);
+}
+
+template class MeshGenerator<2> ;
+template class MeshGenerator<3> ;
+
+} // namespace fch
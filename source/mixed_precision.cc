@@ -0,0 +1,100 @@
+/*
+ * mixed_precision.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/lac/solver_cg.h>
+#include <deal.II/lac/solver_control.h>
+
+#include "mixed_precision.h"
+#include "solver_stats.h"
+
+namespace fch {
+using namespace dealii;
+
+MixedPrecisionCG::MixedPrecisionCG() :
+        inner_reduction(1e-4), n_outer_steps(0) {
+}
+
+void MixedPrecisionCG::set_inner_reduction(const double reduction) {
+    inner_reduction = reduction;
+}
+
+void MixedPrecisionCG::initialize(const SparseMatrix<double> &matrix, const double ssor_param) {
+    // the float matrix shares the sparsity pattern; reallocate only if the pattern changed
+    if (matrix_float.empty() || &matrix_float.get_sparsity_pattern() != &matrix.get_sparsity_pattern()
+            || matrix_float.m() != matrix.m()
+            || matrix_float.n_nonzero_elements() != matrix.n_nonzero_elements())
+        matrix_float.reinit(matrix.get_sparsity_pattern());
+
+    matrix_float.copy_from(matrix);
+    preconditioner.initialize(matrix_float, ssor_param);
+
+    if (residual.size() != matrix.m()) {
+        residual.reinit(matrix.m());
+        residual_float.reinit(matrix.m());
+        correction_float.reinit(matrix.m());
+    }
+}
+
+std::size_t MixedPrecisionCG::memory_consumption() const {
+    return matrix_float.memory_consumption() + residual.memory_consumption()
+            + residual_float.memory_consumption() + correction_float.memory_consumption();
+}
+
+unsigned int MixedPrecisionCG::solve(const Mode mode, const SparseMatrix<double> &matrix,
+        Vector<double> &solution, const Vector<double> &rhs, const unsigned int max_iter,
+        const double tol) {
+
+    Assert(mode != off, ExcMessage("Mixed precision solve requested with mode off"));
+    Assert(matrix_float.m() == matrix.m(), ExcNotInitialized());
+
+    n_outer_steps = 0;
+    residual_history.clear();
+
+    if (mode == float_preconditioner) {
+        // SSOR sweeps read the float matrix but work on the double vectors
+        HistorySolverControl solver_control(max_iter, tol);
+        SolverCG<> solver(solver_control);
+        solver.solve(matrix, solution, rhs, preconditioner);
+        residual_history = solver_control.get_residual_history();
+        return solver_control.last_step();
+    }
+
+    // Defect correction: the residual is evaluated in double precision, the correction
+    // equation A d = r is solved approximately in single precision
+    unsigned int n_steps = 0;
+    while (true) {
+        const double residual_norm = matrix.residual(residual, solution, rhs);
+        residual_history.push_back(residual_norm);
+        if (residual_norm < tol)
+            break;
+        if (n_steps >= max_iter)
+            throw SolverControl::NoConvergence(n_steps, residual_norm);
+
+        residual_float = residual;
+        correction_float = 0;
+
+        ReductionControl inner_control(max_iter - n_steps, 0.0, inner_reduction, false, false);
+        SolverCG<Vector<float> > inner_solver(inner_control);
+        try {
+            inner_solver.solve(matrix_float, correction_float, residual_float, preconditioner);
+        } catch (SolverControl::NoConvergence &) {
+            // the partial correction still reduces the error
+        }
+
+        if (inner_control.last_step() == 0)
+            throw SolverControl::NoConvergence(n_steps, residual_norm);
+
+        n_steps += inner_control.last_step();
+        ++n_outer_steps;
+
+        residual = correction_float;
+        solution += residual;
+    }
+
+    return n_steps;
+}
+
+} // namespace fch
@@ -0,0 +1,218 @@
+/*
+ * multi_vector_cg.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/lac/solver_control.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "multi_vector_cg.h"
+
+namespace fch {
+using namespace dealii;
+
+MultiVectorCG::MultiVectorCG() :
+        n_vectors(0), use_ssor(true), omega(1.2) {
+}
+
+void MultiVectorCG::vmult(const SparseMatrix<double> &matrix, std::vector<double> &dst,
+        const std::vector<double> &src) const {
+    const unsigned int k = n_vectors;
+    for (unsigned int row = 0; row < matrix.m(); ++row) {
+        double *d = &dst[row * k];
+        for (unsigned int j = 0; j < k; ++j)
+            d[j] = 0.0;
+
+        for (SparseMatrix<double>::const_iterator it = matrix.begin(row); it != matrix.end(row); ++it) {
+            const double value = it->value();
+            const double *s = &src[it->column() * k];
+            for (unsigned int j = 0; j < k; ++j)
+                d[j] += value * s[j];
+        }
+    }
+}
+
+void MultiVectorCG::precondition(const SparseMatrix<double> &matrix, std::vector<double> &dst,
+        const std::vector<double> &src) const {
+    if (!use_ssor) {
+        dst = src;
+        return;
+    }
+
+    const unsigned int k = n_vectors;
+    const unsigned int n = matrix.m();
+
+    // forward sweep
+    for (unsigned int row = 0; row < n; ++row) {
+        double *d = &dst[row * k];
+        const double *s = &src[row * k];
+        for (unsigned int j = 0; j < k; ++j)
+            d[j] = s[j];
+
+        for (SparseMatrix<double>::const_iterator it = matrix.begin(row); it != matrix.end(row); ++it) {
+            const unsigned int col = it->column();
+            if (col >= row)
+                continue;
+            const double value = omega * it->value();
+            const double *dc = &dst[col * k];
+            for (unsigned int j = 0; j < k; ++j)
+                d[j] -= value * dc[j];
+        }
+
+        const double inv_diagonal = 1.0 / matrix.diag_element(row);
+        for (unsigned int j = 0; j < k; ++j)
+            d[j] *= inv_diagonal;
+    }
+
+    // scale with the diagonal
+    for (unsigned int row = 0; row < n; ++row) {
+        const double scale = omega * (2.0 - omega) * matrix.diag_element(row);
+        double *d = &dst[row * k];
+        for (unsigned int j = 0; j < k; ++j)
+            d[j] *= scale;
+    }
+
+    // backward sweep
+    for (int row = n - 1; row >= 0; --row) {
+        double *d = &dst[row * k];
+        for (SparseMatrix<double>::const_iterator it = matrix.begin(row); it != matrix.end(row); ++it) {
+            const unsigned int col = it->column();
+            if (col <= (unsigned int) row)
+                continue;
+            const double value = omega * it->value();
+            const double *dc = &dst[col * k];
+            for (unsigned int j = 0; j < k; ++j)
+                d[j] -= value * dc[j];
+        }
+
+        const double inv_diagonal = 1.0 / matrix.diag_element(row);
+        for (unsigned int j = 0; j < k; ++j)
+            d[j] *= inv_diagonal;
+    }
+}
+
+void MultiVectorCG::dot(const std::vector<double> &a, const std::vector<double> &b,
+        std::vector<double> &result) const {
+    const unsigned int k = n_vectors;
+    std::fill(result.begin(), result.end(), 0.0);
+    for (std::size_t i = 0; i < a.size(); i += k)
+        for (unsigned int j = 0; j < k; ++j)
+            result[j] += a[i + j] * b[i + j];
+}
+
+std::size_t MultiVectorCG::memory_consumption() const {
+    return (x.capacity() + r.capacity() + z.capacity() + p.capacity() + q.capacity()) * sizeof(double);
+}
+
+unsigned int MultiVectorCG::solve(const SparseMatrix<double> &matrix,
+        const std::vector<Vector<double> > &rhs, std::vector<Vector<double> > &solutions,
+        const unsigned int max_iter, const double tol, const bool pc_ssor, const double ssor_param) {
+
+    Assert(rhs.size() == solutions.size(), ExcDimensionMismatch(rhs.size(), solutions.size()));
+
+    const unsigned int k = rhs.size();
+    const unsigned int n = matrix.m();
+    n_vectors = k;
+    use_ssor = pc_ssor;
+    omega = ssor_param;
+
+    if (k == 0)
+        return 0;
+
+    x.resize(n * k);
+    r.resize(n * k);
+    z.resize(n * k);
+    p.resize(n * k);
+    q.resize(n * k);
+    rz.resize(k);
+    rz_new.resize(k);
+    pq.resize(k);
+    residual_norm2.resize(k);
+    active.assign(k, true);
+    iterations.assign(k, 0);
+
+    for (unsigned int j = 0; j < k; ++j) {
+        Assert(rhs[j].size() == n, ExcDimensionMismatch(rhs[j].size(), n));
+        if (solutions[j].size() != n)
+            solutions[j].reinit(n);
+        for (unsigned int i = 0; i < n; ++i)
+            x[i * k + j] = solutions[j](i);
+    }
+
+    // r = b - A x
+    vmult(matrix, q, x);
+    for (unsigned int i = 0; i < n; ++i)
+        for (unsigned int j = 0; j < k; ++j)
+            r[i * k + j] = rhs[j](i) - q[i * k + j];
+
+    dot(r, r, residual_norm2);
+    bool any_active = false;
+    for (unsigned int j = 0; j < k; ++j) {
+        active[j] = std::sqrt(residual_norm2[j]) >= tol;
+        any_active = any_active || active[j];
+    }
+
+    precondition(matrix, z, r);
+    dot(r, z, rz);
+    p = z;
+
+    unsigned int iteration = 0;
+    while (any_active && iteration < max_iter) {
+        ++iteration;
+
+        vmult(matrix, q, p);
+        dot(p, q, pq);
+
+        for (unsigned int i = 0; i < n * k; i += k)
+            for (unsigned int j = 0; j < k; ++j) {
+                if (!active[j])
+                    continue;
+                const double alpha = rz[j] / pq[j];
+                x[i + j] += alpha * p[i + j];
+                r[i + j] -= alpha * q[i + j];
+            }
+
+        dot(r, r, residual_norm2);
+        any_active = false;
+        for (unsigned int j = 0; j < k; ++j) {
+            if (!active[j])
+                continue;
+            iterations[j] = iteration;
+            active[j] = std::sqrt(residual_norm2[j]) >= tol;
+            any_active = any_active || active[j];
+        }
+        if (!any_active)
+            break;
+
+        precondition(matrix, z, r);
+        dot(r, z, rz_new);
+
+        for (unsigned int i = 0; i < n * k; i += k)
+            for (unsigned int j = 0; j < k; ++j) {
+                if (!active[j])
+                    continue;
+                p[i + j] = z[i + j] + (rz_new[j] / rz[j]) * p[i + j];
+            }
+        for (unsigned int j = 0; j < k; ++j)
+            rz[j] = rz_new[j];
+    }
+
+    for (unsigned int j = 0; j < k; ++j)
+        for (unsigned int i = 0; i < n; ++i)
+            solutions[j](i) = x[i * k + j];
+
+    if (any_active) {
+        double max_residual = 0.0;
+        for (unsigned int j = 0; j < k; ++j)
+            if (active[j])
+                max_residual = std::max(max_residual, std::sqrt(residual_norm2[j]));
+        throw SolverControl::NoConvergence(iteration, max_residual);
+    }
+
+    return iteration;
+}
+
+} // namespace fch
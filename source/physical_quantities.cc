@@ -75,6 +75,12 @@ double PhysicalQuantities::dkappa(double temperature) {
     return lorentz * (sigma(temperature) + temperature * dsigma(temperature));
 }
 
+std::size_t PhysicalQuantities::memory_consumption() const {
+    return sizeof(*this) + emission_grid.v.capacity() * sizeof(double)
+            + nottingham_grid.v.capacity() * sizeof(double)
+            + resistivity_data.capacity() * sizeof(std::pair<double, double>);
+}
+
 bool PhysicalQuantities::load_spreadsheet_grid_data(std::string filepath, InterpolationGrid &grid) {
     std::ifstream infile(filepath);
     if (!infile) {
@@ -166,6 +172,8 @@ bool PhysicalQuantities::load_resistivity_data(std::string filepath) {
         std::cerr << "Couldn't open \"" << filepath << "\"\n";
         return false;
     }
+    // replace the hardcoded data instead of appending to it
+    resistivity_data.clear();
     double x, y;
     while (infile >> x >> y) {
         resistivity_data.push_back(std::make_pair(x, y));
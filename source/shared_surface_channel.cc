@@ -0,0 +1,233 @@
+/*
+ * shared_surface_channel.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+
+#include "shared_surface_channel.h"
+
+namespace fch {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the frame counters must be lock free to work across processes");
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "the magic number must be lock free to work across processes");
+
+namespace {
+const std::uint32_t channel_magic = 0x46435353;   ///< "SSCF" in little endian
+const std::uint32_t channel_version = 1;
+const unsigned int n_spins = 1000;                ///< polls before the waiting starts to sleep
+
+/** Bytes rounded up to a cache line */
+std::size_t cache_aligned(const std::size_t bytes) {
+    return (bytes + 63) / 64 * 64;
+}
+
+/** Polls the condition until it holds or the timeout [s] passes; negative timeout waits forever */
+template<typename Condition>
+bool wait_for(Condition condition, const double timeout) {
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; !condition(); ++i) {
+        if (i < n_spins) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (timeout >= 0.0
+                && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() > timeout)
+            return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+    return true;
+}
+}
+
+SharedSurfaceChannel::SharedSurfaceChannel() :
+        owner(false), size(0), header(NULL), n_faces(0), centroids(NULL), buffers { NULL, NULL },
+        acquired { 0, 0 } {
+}
+
+SharedSurfaceChannel::~SharedSurfaceChannel() {
+    close();
+}
+
+unsigned int SharedSurfaceChannel::n_arrays(const Direction direction) {
+    return direction == to_solver ? 3 : 1;
+}
+
+std::size_t SharedSurfaceChannel::segment_size(const unsigned int dim, const unsigned int n_faces) {
+    std::size_t bytes = cache_aligned(sizeof(Header)) + cache_aligned(sizeof(double) * dim * n_faces);
+    for (unsigned int d = 0; d < 2; ++d)
+        bytes += 2 * cache_aligned(sizeof(double) * n_arrays(Direction(d)) * n_faces);
+    return bytes;
+}
+
+void SharedSurfaceChannel::map_arrays() {
+    n_faces = header->n_faces;
+    char *p = reinterpret_cast<char*>(header) + cache_aligned(sizeof(Header));
+    centroids = reinterpret_cast<double*>(p);
+    p += cache_aligned(sizeof(double) * header->dim * n_faces);
+    for (unsigned int d = 0; d < 2; ++d) {
+        buffers[d] = reinterpret_cast<double*>(p);
+        p += 2 * cache_aligned(sizeof(double) * n_arrays(Direction(d)) * n_faces);
+    }
+    acquired[0] = acquired[1] = 0;
+}
+
+bool SharedSurfaceChannel::create(const std::string &name_, const unsigned int dim,
+        const unsigned int n_faces_) {
+    close();
+
+    const int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "Error: couldn't create shared memory " << name_ << ": " << std::strerror(errno)
+                << std::endl;
+        return false;
+    }
+
+    const std::size_t size_ = segment_size(dim, n_faces_);
+    void *memory = MAP_FAILED;
+    if (ftruncate(fd, size_) == 0)
+        memory = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: couldn't map shared memory " << name_ << ": " << std::strerror(errno)
+                << std::endl;
+        shm_unlink(name_.c_str());
+        return false;
+    }
+
+    // the segment is zero filled, so only the atomics need constructing
+    header = static_cast<Header*>(memory);
+    new (&header->magic) std::atomic<std::uint32_t>(0);
+    header->dim = dim;
+    header->n_faces = n_faces_;
+    for (unsigned int d = 0; d < 2; ++d) {
+        new (&header->counters[d].published) std::atomic<unsigned long long>(0);
+        new (&header->counters[d].released) std::atomic<unsigned long long>(0);
+    }
+    header->version = channel_version;
+    // the magic is stored last; the peer that loads it sees the header fields and counters above
+    header->magic.store(channel_magic, std::memory_order_release);
+
+    name = name_;
+    owner = true;
+    size = size_;
+    map_arrays();
+    return true;
+}
+
+bool SharedSurfaceChannel::open(const std::string &name_) {
+    close();
+
+    const int fd = shm_open(name_.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        std::cerr << "Error: couldn't open shared memory " << name_ << ": " << std::strerror(errno)
+                << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    void *memory = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && std::size_t(info.st_size) >= sizeof(Header))
+        memory = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        std::cerr << "Error: couldn't map shared memory " << name_ << std::endl;
+        return false;
+    }
+
+    // the magic must be loaded before the other header fields are read
+    Header *h = static_cast<Header*>(memory);
+    if (h->magic.load(std::memory_order_acquire) != channel_magic || h->version != channel_version
+            || std::size_t(info.st_size) < segment_size(h->dim, h->n_faces)) {
+        std::cerr << "Error: " << name_ << " is not a surface channel" << std::endl;
+        munmap(memory, info.st_size);
+        return false;
+    }
+
+    header = h;
+    name = name_;
+    owner = false;
+    size = info.st_size;
+    map_arrays();
+    return true;
+}
+
+void SharedSurfaceChannel::close() {
+    if (header == NULL)
+        return;
+    munmap(header, size);
+    if (owner)
+        shm_unlink(name.c_str());
+    header = NULL;
+    centroids = buffers[0] = buffers[1] = NULL;
+    n_faces = 0;
+    owner = false;
+}
+
+unsigned int SharedSurfaceChannel::get_dim() const {
+    return header ? header->dim : 0;
+}
+
+unsigned int SharedSurfaceChannel::get_n_faces() const {
+    return n_faces;
+}
+
+double* SharedSurfaceChannel::get_centroids() {
+    return centroids;
+}
+
+double* SharedSurfaceChannel::buffer(const Direction direction, const unsigned long long frame) {
+    const std::size_t buffer_size = cache_aligned(sizeof(double) * n_arrays(direction) * n_faces)
+            / sizeof(double);
+    return buffers[direction] + (frame % 2) * buffer_size;
+}
+
+double* SharedSurfaceChannel::begin_write(const Direction direction, const double timeout) {
+    Counters &c = header->counters[direction];
+    const unsigned long long published = c.published.load(std::memory_order_relaxed);
+
+    // the buffer of the next frame held the frame before the last published one
+    if (!wait_for([&c, published]() {
+        return published < 2 || c.released.load(std::memory_order_acquire) + 1 >= published;
+    }, timeout))
+        return NULL;
+
+    return buffer(direction, published + 1);
+}
+
+void SharedSurfaceChannel::publish(const Direction direction) {
+    header->counters[direction].published.fetch_add(1, std::memory_order_release);
+}
+
+const double* SharedSurfaceChannel::acquire(const Direction direction, const std::uint64_t frame,
+        const double timeout) {
+    Counters &c = header->counters[direction];
+    if (!wait_for([&c, frame]() {
+        return c.published.load(std::memory_order_acquire) >= frame;
+    }, timeout))
+        return NULL;
+
+    acquired[direction] = c.published.load(std::memory_order_acquire);
+    return buffer(direction, acquired[direction]);
+}
+
+void SharedSurfaceChannel::release(const Direction direction) {
+    header->counters[direction].released.store(acquired[direction], std::memory_order_release);
+}
+
+std::uint64_t SharedSurfaceChannel::get_published(const Direction direction) const {
+    return header->counters[direction].published.load(std::memory_order_acquire);
+}
+
+} // namespace fch
@@ -0,0 +1,341 @@
+/*
+ * solver_service.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <deal.II/base/timer.h>
+
+#include "solver_service.h"
+
+namespace fch {
+
+namespace {
+
+/** Largest accepted payload; protects against reading garbage as a size */
+const std::uint64_t max_payload_size = std::uint64_t(1) << 32;
+
+bool read_all(int fd, void *data, std::size_t size) {
+    char *p = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::read(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool write_all(int fd, const void *data, std::size_t size) {
+    const char *p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+struct MessageHeader {
+    std::uint32_t magic;
+    std::uint32_t type;
+    std::uint64_t size;
+};
+
+/** Sequential reader of the payload values that fails instead of reading past the end */
+class PayloadReader {
+public:
+    PayloadReader(const std::vector<char> &payload_) :
+            payload(payload_), position(0) {
+    }
+
+    template<typename T>
+    bool read(T &value) {
+        if (position + sizeof(T) > payload.size())
+            return false;
+        std::memcpy(&value, payload.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    std::size_t remaining() const {
+        return payload.size() - position;
+    }
+
+private:
+    const std::vector<char> &payload;
+    std::size_t position;
+};
+
+template<typename T>
+void append(std::vector<char> &buffer, const T value) {
+    const char *p = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(T));
+}
+
+} // namespace
+
+template<int dim>
+SolverService<dim>::SolverService(PhysicalQuantities *pq_) :
+        pq(pq_), vacuum_ready(false), vacuum_assembled(false), assembled_efield(0.0), active(0),
+        copper_ready(false), copper_solved(false), n_requests(0) {
+    for (auto &ch : ch_solvers) {
+        ch.set_physical_quantities(pq);
+        ch.set_warm_start(true);
+    }
+}
+
+template<int dim>
+bool SolverService<dim>::serve(const std::string &socket_path) {
+    sockaddr_un address;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: socket path too long: " << socket_path << std::endl;
+        return false;
+    }
+
+    const int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        std::cerr << "Error: couldn't create socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(socket_path.c_str());
+
+    if (::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+            || ::listen(server, 1) < 0) {
+        std::cerr << "Error: couldn't listen on " << socket_path << ": " << std::strerror(errno)
+                << std::endl;
+        ::close(server);
+        return false;
+    }
+
+    // a client disconnecting during a reply must not kill the service
+    std::signal(SIGPIPE, SIG_IGN);
+
+    bool stop = false;
+    while (!stop) {
+        const int client = ::accept(server, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "Error: accept failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        stop = serve_connection(client, client);
+        ::close(client);
+    }
+
+    ::close(server);
+    ::unlink(socket_path.c_str());
+    return true;
+}
+
+template<int dim>
+bool SolverService<dim>::serve_connection(int in_fd, int out_fd) {
+    std::vector<char> payload, reply;
+
+    while (true) {
+        MessageHeader header;
+        if (!read_all(in_fd, &header, sizeof(header)))
+            return false;
+        if (header.magic != magic || header.size > max_payload_size) {
+            std::cerr << "Error: invalid message header, closing the connection" << std::endl;
+            return false;
+        }
+
+        payload.resize(header.size);
+        if (!read_all(in_fd, payload.data(), payload.size()))
+            return false;
+
+        reply.clear();
+        const Status status = handle_request(header.type, payload, reply);
+
+        MessageHeader reply_header;
+        reply_header.magic = magic;
+        reply_header.type = header.type;
+        reply_header.size = sizeof(std::int32_t) + reply.size();
+        const std::int32_t status_value = status;
+        if (!write_all(out_fd, &reply_header, sizeof(reply_header))
+                || !write_all(out_fd, &status_value, sizeof(status_value))
+                || !write_all(out_fd, reply.data(), reply.size()))
+            return false;
+
+        if (header.type == shutdown)
+            return true;
+    }
+}
+
+template<int dim>
+typename SolverService<dim>::Status SolverService<dim>::handle_request(std::uint32_t type,
+        const std::vector<char> &payload, std::vector<char> &reply) {
+    ++n_requests;
+
+    // a failing request (e.g. CG not converging) must not end the service
+    try {
+        switch (type) {
+        case set_vacuum_mesh:
+            return import_mesh(true, payload, reply);
+        case set_copper_mesh:
+            return import_mesh(false, payload, reply);
+        case set_parameters:
+            return read_parameters(payload);
+        case run:
+            return payload.empty() ? run_solvers(reply) : bad_request;
+        case shutdown:
+            return ok;
+        default:
+            return bad_request;
+        }
+    } catch (std::exception &exc) {
+        std::cerr << "Error: request " << type << " failed: " << exc.what() << std::endl;
+        reply.clear();
+        return type == run ? run_failed : mesh_failed;
+    }
+}
+
+template<int dim>
+typename SolverService<dim>::Status SolverService<dim>::import_mesh(bool vacuum,
+        const std::vector<char> &payload, std::vector<char> &reply) {
+    const unsigned int n_cell_vertices = GeometryInfo<dim>::vertices_per_cell;
+
+    PayloadReader reader(payload);
+    std::uint32_t n_vertices, n_cells;
+    if (!reader.read(n_vertices) || !reader.read(n_cells)
+            || reader.remaining() != std::size_t(n_vertices) * dim * sizeof(double)
+                    + std::size_t(n_cells) * n_cell_vertices * sizeof(std::uint32_t))
+        return bad_request;
+
+    std::vector<Point<dim> > vertices(n_vertices);
+    for (auto &vertex : vertices)
+        for (int d = 0; d < dim; ++d)
+            reader.read(vertex[d]);
+
+    std::vector<CellData<dim> > cells(n_cells);
+    for (auto &cell : cells) {
+        for (unsigned int v = 0; v < n_cell_vertices; ++v) {
+            std::uint32_t index;
+            reader.read(index);
+            if (index >= n_vertices)
+                return bad_request;
+            cell.vertices[v] = index;
+        }
+        cell.material_id = 0;
+    }
+
+    std::uint32_t n_dofs;
+    if (vacuum) {
+        vacuum_ready = vacuum_assembled = false;
+        if (!laplace.import_mesh_directly(vertices, cells))
+            return mesh_failed;
+        laplace.setup_system();
+        vacuum_ready = true;
+        n_dofs = laplace.get_dof_handler()->n_dofs();
+    } else {
+        // keep the previous solver for the initial condition interpolation
+        const unsigned int previous = active;
+        CurrentsAndHeatingStationary<dim> &ch = ch_solvers[1 - previous];
+        ch.reinitialize(&laplace, copper_solved ? &ch_solvers[previous] : NULL);
+        if (!ch.import_mesh_directly(vertices, cells))
+            return mesh_failed;
+        ch.set_ambient_temperature(parameters.ambient_temperature);
+        ch.setup_system();
+
+        active = 1 - previous;
+        copper_ready = true;
+        copper_solved = false;
+        n_dofs = ch.get_dof_handler()->n_dofs();
+    }
+
+    append(reply, n_dofs);
+    return ok;
+}
+
+template<int dim>
+typename SolverService<dim>::Status SolverService<dim>::read_parameters(const std::vector<char> &payload) {
+    PayloadReader reader(payload);
+    Parameters p;
+    if (!reader.read(p.applied_efield) || !reader.read(p.ambient_temperature)
+            || !reader.read(p.temperature_tolerance) || !reader.read(p.max_newton_iter)
+            || !reader.read(p.sor_alpha) || !reader.read(p.laplace_tolerance)
+            || !reader.read(p.laplace_max_iter) || reader.remaining() != 0)
+        return bad_request;
+    if (p.max_newton_iter < 1 || p.laplace_max_iter < 1)
+        return bad_request;
+
+    parameters = p;
+    // a changed ambient temperature discards the warm solution of the copper solver
+    ch_solvers[active].set_ambient_temperature(parameters.ambient_temperature);
+    return ok;
+}
+
+template<int dim>
+typename SolverService<dim>::Status SolverService<dim>::run_solvers(std::vector<char> &reply) {
+    if (!vacuum_ready || !copper_ready)
+        return not_ready;
+
+    Timer timer;
+
+    // Only the rhs depends on the applied field, so the assembled system is reused
+    if (!vacuum_assembled || (parameters.applied_efield != assembled_efield
+            && !laplace.rescale_applied_efield(parameters.applied_efield))) {
+        laplace.set_applied_efield(parameters.applied_efield);
+        laplace.assemble_system();
+        vacuum_assembled = true;
+    }
+    assembled_efield = parameters.applied_efield;
+
+    const SolveStats field_stats = laplace.solve(parameters.laplace_max_iter,
+            parameters.laplace_tolerance);
+
+    CurrentsAndHeatingStationary<dim> &ch = ch_solvers[active];
+    const NewtonStats stats = ch.run_specific(parameters.temperature_tolerance,
+            parameters.max_newton_iter, false, "", false, parameters.sor_alpha);
+    if (stats.temperature_error < 0.0)
+        return run_failed;
+    copper_solved = true;
+
+    std::vector<Point<dim> > nodes;
+    std::vector<double> fields, temperatures;
+    ch.get_surface_values(nodes, fields, temperatures);
+
+    append(reply, std::int32_t(stats.iterations));
+    append(reply, std::uint32_t(stats.converged));
+    append(reply, stats.temperature_error);
+    append(reply, stats.peak_temperature);
+    append(reply, std::uint32_t(field_stats.iterations));
+    append(reply, timer.wall_time());
+    append(reply, std::uint32_t(nodes.size()));
+
+    reply.reserve(reply.size() + nodes.size() * (dim + 2) * sizeof(double));
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        for (int d = 0; d < dim; ++d)
+            append(reply, nodes[i][d]);
+        append(reply, fields[i]);
+        append(reply, temperatures[i]);
+    }
+    return ok;
+}
+
+template class SolverService<2> ;
+template class SolverService<3> ;
+
+} // namespace fch
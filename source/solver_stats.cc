@@ -0,0 +1,32 @@
+/*
+ * solver_stats.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "solver_stats.h"
+
+namespace fch {
+
+HistorySolverControl::HistorySolverControl(const unsigned int max_steps, const double tolerance) :
+        SolverControl(max_steps, tolerance) {
+}
+
+SolverControl::State HistorySolverControl::check(const unsigned int step, const double check_value) {
+    // the capacity is kept between the solves, so the history allocates only on the first one
+    if (step == 0) {
+        residual_history.clear();
+        residual_history.reserve(max_steps() + 1);
+    }
+    residual_history.push_back(check_value);
+    return SolverControl::check(step, check_value);
+}
+
+void HistorySolverControl::fill(SolveStats &stats) const {
+    stats.iterations = last_step();
+    stats.residual = last_value();
+    stats.residual_history = residual_history;
+    stats.converged = true;
+}
+
+} // namespace fch
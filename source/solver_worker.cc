@@ -0,0 +1,60 @@
+/*
+ * solver_worker.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "solver_worker.h"
+
+namespace fch {
+
+SolverWorker::SolverWorker() :
+        running(0), stopping(false) {
+}
+
+SolverWorker::~SolverWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+    if (thread.joinable())
+        thread.join();
+}
+
+unsigned int SolverWorker::n_pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return jobs.size() + running;
+}
+
+void SolverWorker::enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+        if (!thread.joinable())
+            thread = std::thread(&SolverWorker::work, this);
+    }
+    condition.notify_one();
+}
+
+void SolverWorker::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this]() {
+            return stopping || !jobs.empty();
+        });
+        // the queued jobs are finished even when stopping, their futures are waited for
+        if (jobs.empty())
+            return;
+
+        std::function<void()> job = jobs.front();
+        jobs.pop_front();
+        running = 1;
+        lock.unlock();
+        job();
+        lock.lock();
+        running = 0;
+    }
+}
+
+} // namespace fch
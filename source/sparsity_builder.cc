@@ -0,0 +1,134 @@
+/*
+ * sparsity_builder.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <deal.II/dofs/dof_accessor.h>
+#include <deal.II/grid/tria.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "sparsity_builder.h"
+
+namespace fch {
+
+namespace {
+typedef types::global_dof_index size_type;
+
+/** Appends the dofs that the local dof couples to after the elimination of the constraints */
+void add_expanded_dof(const ConstraintMatrix &constraints, const size_type dof,
+        std::vector<size_type> &dofs) {
+    if (!constraints.is_constrained(dof)) {
+        dofs.push_back(dof);
+        return;
+    }
+    const std::vector<std::pair<size_type, double> > *entries = constraints.get_constraint_entries(dof);
+    if (entries)
+        for (unsigned int i = 0; i < entries->size(); ++i)
+            dofs.push_back((*entries)[i].first);
+}
+
+/** Sorted distinct columns of the row */
+void row_columns(const ConstraintMatrix &constraints, const size_type row,
+        const std::vector<size_type> &cell_dofs, const unsigned int dofs_per_cell,
+        const std::vector<std::size_t> &row_start, const std::vector<unsigned int> &row_cells,
+        std::vector<size_type> &columns) {
+    columns.clear();
+
+    // only the diagonal is kept in the constrained rows
+    if (constraints.is_constrained(row)) {
+        columns.push_back(row);
+        return;
+    }
+
+    for (std::size_t k = row_start[row]; k < row_start[row + 1]; ++k) {
+        const size_type *dofs = &cell_dofs[std::size_t(row_cells[k]) * dofs_per_cell];
+        for (unsigned int j = 0; j < dofs_per_cell; ++j)
+            add_expanded_dof(constraints, dofs[j], columns);
+    }
+
+    std::sort(columns.begin(), columns.end());
+    columns.erase(std::unique(columns.begin(), columns.end()), columns.end());
+}
+}
+
+template<int dim>
+void make_static_sparsity_pattern(const DoFHandler<dim> &dof_handler,
+        const ConstraintMatrix &constraints, SparsityPattern &sparsity) {
+
+    const size_type n_dofs = dof_handler.n_dofs();
+    const unsigned int dofs_per_cell = dof_handler.get_fe().dofs_per_cell;
+    const unsigned int n_cells = dof_handler.get_triangulation().n_active_cells();
+
+    // Dof indices of the cells in the order of the active cell iterators
+    std::vector<size_type> cell_dofs(std::size_t(n_cells) * dofs_per_cell);
+    std::vector<size_type> local_dof_indices(dofs_per_cell);
+    unsigned int cell_index = 0;
+    for (typename DoFHandler<dim>::active_cell_iterator cell = dof_handler.begin_active();
+            cell != dof_handler.end(); ++cell, ++cell_index) {
+        cell->get_dof_indices(local_dof_indices);
+        std::copy(local_dof_indices.begin(), local_dof_indices.end(),
+                cell_dofs.begin() + std::size_t(cell_index) * dofs_per_cell);
+    }
+
+    // Invert into the cells that contribute to every row (CSR)
+    std::vector<std::size_t> row_start(n_dofs + 1, 0);
+    std::vector<size_type> expanded;
+    for (std::size_t i = 0; i < cell_dofs.size(); ++i) {
+        expanded.clear();
+        add_expanded_dof(constraints, cell_dofs[i], expanded);
+        for (unsigned int k = 0; k < expanded.size(); ++k)
+            ++row_start[expanded[k] + 1];
+    }
+    for (size_type row = 0; row < n_dofs; ++row)
+        row_start[row + 1] += row_start[row];
+
+    std::vector<unsigned int> row_cells(row_start[n_dofs]);
+    {
+        std::vector<std::size_t> next_free(row_start.begin(), row_start.end() - 1);
+        for (std::size_t i = 0; i < cell_dofs.size(); ++i) {
+            expanded.clear();
+            add_expanded_dof(constraints, cell_dofs[i], expanded);
+            for (unsigned int k = 0; k < expanded.size(); ++k)
+                row_cells[next_free[expanded[k]]++] = i / dofs_per_cell;
+        }
+    }
+
+    // Counting pass: exact number of distinct columns per row
+    std::vector<unsigned int> row_lengths(n_dofs);
+    std::vector<size_type> columns;
+    for (size_type row = 0; row < n_dofs; ++row) {
+        row_columns(constraints, row, cell_dofs, dofs_per_cell, row_start, row_cells, columns);
+        row_lengths[row] = columns.size();
+    }
+
+    // Filling pass directly into the static pattern
+    sparsity.reinit(n_dofs, n_dofs, row_lengths);
+    std::vector<unsigned int>().swap(row_lengths);
+    for (size_type row = 0; row < n_dofs; ++row) {
+        row_columns(constraints, row, cell_dofs, dofs_per_cell, row_start, row_cells, columns);
+        sparsity.add_entries(row, columns.begin(), columns.end(), true);
+    }
+
+    // release the scratch before compress allocates the final column array
+    std::vector<size_type>().swap(cell_dofs);
+    std::vector<std::size_t>().swap(row_start);
+    std::vector<unsigned int>().swap(row_cells);
+    sparsity.compress();
+}
+
+template<int dim>
+void make_static_sparsity_pattern(const DoFHandler<dim> &dof_handler, SparsityPattern &sparsity) {
+    ConstraintMatrix no_constraints;
+    no_constraints.close();
+    make_static_sparsity_pattern(dof_handler, no_constraints, sparsity);
+}
+
+template void make_static_sparsity_pattern<2>(const DoFHandler<2> &, const ConstraintMatrix &, SparsityPattern &);
+template void make_static_sparsity_pattern<3>(const DoFHandler<3> &, const ConstraintMatrix &, SparsityPattern &);
+template void make_static_sparsity_pattern<2>(const DoFHandler<2> &, SparsityPattern &);
+template void make_static_sparsity_pattern<3>(const DoFHandler<3> &, SparsityPattern &);
+
+} // namespace fch
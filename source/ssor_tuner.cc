@@ -0,0 +1,91 @@
+/*
+ * ssor_tuner.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <cmath>
+
+#include "ssor_tuner.h"
+
+namespace fch {
+
+namespace {
+const double golden_ratio = 0.5 * (std::sqrt(5.0) - 1.0);  ///< 0.618...
+const double min_bracket = 0.02;        ///< omega resolution at which the search stops
+const double average_weight = 0.2;      ///< weight of the newest solve in the running average
+const double min_drift = 2.0;           ///< iteration growth that is never considered a drift
+}
+
+SSORTuner::SSORTuner(const double omega_min_, const double omega_max_,
+        const unsigned int max_search_solves_, const double drift_tolerance_) :
+        omega_min(omega_min_), omega_max(omega_max_), max_search_solves(max_search_solves_),
+        drift_tolerance(drift_tolerance_) {
+    restart();
+}
+
+void SSORTuner::restart() {
+    locked = false;
+    lower = omega_min;
+    upper = omega_max;
+    x1 = upper - golden_ratio * (upper - lower);
+    x2 = lower + golden_ratio * (upper - lower);
+    f1 = f2 = -1.0;
+    n_evaluations = 0;
+    best_omega = x1;
+    best_iterations = -1.0;
+    average_iterations = 0.0;
+    omega = x1;
+}
+
+void SSORTuner::lock() {
+    locked = true;
+    omega = best_omega;
+    average_iterations = best_iterations;
+}
+
+void SSORTuner::add_result(const unsigned int iterations) {
+    const double cost = iterations;
+
+    if (locked) {
+        if (cost > (1.0 + drift_tolerance) * average_iterations && cost > average_iterations + min_drift)
+            restart();
+        else
+            average_iterations += average_weight * (cost - average_iterations);
+        return;
+    }
+
+    if (best_iterations < 0.0 || cost < best_iterations) {
+        best_iterations = cost;
+        best_omega = omega;
+    }
+
+    if (omega == x1)
+        f1 = cost;
+    else
+        f2 = cost;
+    ++n_evaluations;
+
+    // shrink the bracket once both inner points are known; one of them is reused
+    if (f1 >= 0.0 && f2 >= 0.0) {
+        if (f1 <= f2) {
+            upper = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = upper - golden_ratio * (upper - lower);
+            f1 = -1.0;
+        } else {
+            lower = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = lower + golden_ratio * (upper - lower);
+            f2 = -1.0;
+        }
+    }
+    omega = f1 < 0.0 ? x1 : x2;
+
+    if (n_evaluations >= max_search_solves || upper - lower < min_bracket)
+        lock();
+}
+
+} // namespace fch
@@ -0,0 +1,154 @@
+/*
+ * trace_recorder.cc
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <unistd.h>  // getpid
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "trace_recorder.h"
+
+namespace fch {
+
+namespace {
+/** String with the JSON special characters escaped */
+std::string json_escape(const std::string &s) {
+    std::string escaped;
+    escaped.reserve(s.size());
+    for (unsigned int i = 0; i < s.size(); ++i) {
+        const char c = s[i];
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else
+            escaped += c;
+    }
+    return escaped;
+}
+}
+
+TraceRecorder::TraceRecorder() :
+        start(std::chrono::steady_clock::now()) {
+}
+
+void TraceRecorder::begin(const char *name, const char *category) {
+    std::lock_guard<std::mutex> lock(mutex);
+    add_event('B', name, category, 0.0);
+}
+
+void TraceRecorder::end() {
+    std::lock_guard<std::mutex> lock(mutex);
+    add_event('E', "", "", 0.0);
+}
+
+void TraceRecorder::counter(const char *name, const double value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    add_event('C', name, "fch", value);
+}
+
+void TraceRecorder::instant(const char *name, const char *category) {
+    std::lock_guard<std::mutex> lock(mutex);
+    add_event('i', name, category, 0.0);
+}
+
+void TraceRecorder::set_thread_name(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    thread_names[thread_id()] = name;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+}
+
+std::size_t TraceRecorder::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return events.size();
+}
+
+void TraceRecorder::add_event(const char phase, const char *name, const char *category,
+        const double value) {
+    Event event;
+    event.phase = phase;
+    event.thread = thread_id();
+    event.timestamp = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+    event.value = value;
+    event.name = name;
+    event.category = category;
+    events.push_back(event);
+}
+
+unsigned int TraceRecorder::thread_id() {
+    const std::thread::id id = std::this_thread::get_id();
+    std::map<std::thread::id, unsigned int>::const_iterator it = thread_ids.find(id);
+    if (it != thread_ids.end())
+        return it->second;
+
+    const unsigned int new_id = thread_ids.size() + 1;
+    thread_ids[id] = new_id;
+    return new_id;
+}
+
+bool TraceRecorder::write(const std::string &file_name) const {
+    std::ofstream out(file_name);
+    if (!out) {
+        std::cerr << "WARNING: Couldn't open " + file_name << ". ";
+        std::cerr << "Trace is not saved." << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const int pid = getpid();
+    char line[64];
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":0,\"args\":{\"name\":\"fch\"}}";
+
+    for (std::map<unsigned int, std::string>::const_iterator it = thread_names.begin();
+            it != thread_names.end(); ++it)
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << it->first
+                << ",\"args\":{\"name\":\"" << json_escape(it->second) << "\"}}";
+
+    for (unsigned int i = 0; i < events.size(); ++i) {
+        const Event &e = events[i];
+        std::snprintf(line, sizeof(line), "%.3f", e.timestamp);
+
+        out << ",\n{\"ph\":\"" << e.phase << "\",\"ts\":" << line << ",\"pid\":" << pid
+                << ",\"tid\":" << e.thread;
+        if (e.phase != 'E')
+            out << ",\"name\":\"" << json_escape(e.name) << "\",\"cat\":\"" << json_escape(e.category) << "\"";
+        if (e.phase == 'C') {
+            // JSON has no representation for inf and nan
+            std::snprintf(line, sizeof(line), "%.10g", std::isfinite(e.value) ? e.value : 0.0);
+            out << ",\"args\":{\"value\":" << line << "}";
+        } else if (e.phase == 'i')
+            out << ",\"s\":\"t\"";
+        out << "}";
+    }
+    out << "\n]}\n";
+    return bool(out);
+}
+
+TraceRecorder::Scope::Scope(TraceRecorder *recorder_, const char *name, const char *category) :
+        recorder(recorder_) {
+    if (recorder)
+        recorder->begin(name, category);
+}
+
+TraceRecorder::Scope::~Scope() {
+    if (recorder)
+        recorder->end();
+}
+
+} // namespace fch